@@ -0,0 +1,523 @@
+#include <QtTest>
+#include <QFile>
+#include <QImageWriter>
+#include <QRandomGenerator>
+#include <QSettings>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QThreadPool>
+
+#include "qvapplication.h"
+#include "qvfileenumerator.h"
+#include "qvimagecore.h"
+#include "qvimageloader.h"
+
+#if defined Q_OS_WIN
+#include <windows.h>
+#include <psapi.h>
+#elif defined Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+// Corpora are generated into a temporary directory, so pointing TMPDIR at a tmpfs mount keeps
+// disk speed out of the numbers
+class LoadingBenchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkDecode_data();
+    void benchmarkDecode();
+    void benchmarkTimeToFirstPixel_data();
+    void benchmarkTimeToFirstPixel();
+    void benchmarkPreloadHitRate_data();
+    void benchmarkPreloadHitRate();
+
+private:
+    QString getCorpusImage(const QByteArray &format, const QSize &size);
+    QString getCorpusFolder(const int fileCount);
+
+    QTemporaryDir corpusDir;
+    QHash<QString, QString> corpusImages;
+    QHash<int, QString> corpusFolders;
+};
+
+class FileEnumeratorBenchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void benchmarkGetCompatibleFiles_data();
+    void benchmarkGetCompatibleFiles();
+
+private:
+    QString getTree(const int fileCount, const bool isRecursive);
+
+    QTemporaryDir treeDir;
+    QHash<QString, QString> trees;
+    QVariant originalAllowMimeContentDetection;
+};
+
+static qint64 getPeakResidentBytes()
+{
+#if defined Q_OS_WIN
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#elif defined Q_OS_UNIX
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef Q_OS_MACOS
+    return usage.ru_maxrss;
+#else
+    return qint64(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+static QImage createCorpusContent(const QSize &size)
+{
+    // A gradient with some noise compresses roughly like a photo, unlike a flat fill
+    QImage image(size, QImage::Format_RGB32);
+    QRandomGenerator random(size.width() * 31 + size.height());
+    for (int y = 0; y < image.height(); ++y)
+    {
+        QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(y));
+        for (int x = 0; x < image.width(); ++x)
+        {
+            const int noise = random.bounded(32);
+            line[x] = qRgb((x * 223 / image.width() + noise) & 0xff, (y * 223 / image.height() + noise) & 0xff, ((x ^ y) + noise) & 0xff);
+        }
+    }
+    return image;
+}
+
+static bool writeGif(const QString &path, const QImage &source)
+{
+    // Qt can read GIFs but not write them. This writes a single frame with a 3-3-2 palette and
+    // uncompressed LZW, clearing the code table often enough that codes stay 9 bits wide.
+    const QImage image = source.convertToFormat(QImage::Format_RGB32);
+    QByteArray data("GIF89a");
+    const auto appendWord = [&data](const int value) {
+        data.append(char(value & 0xff));
+        data.append(char((value >> 8) & 0xff));
+    };
+
+    appendWord(image.width());
+    appendWord(image.height());
+    data.append(char(0xf7));
+    data.append(char(0));
+    data.append(char(0));
+    for (int i = 0; i < 256; ++i)
+    {
+        data.append(char(((i >> 5) & 7) * 255 / 7));
+        data.append(char(((i >> 2) & 7) * 255 / 7));
+        data.append(char((i & 3) * 255 / 3));
+    }
+
+    data.append(',');
+    appendWord(0);
+    appendWord(0);
+    appendWord(image.width());
+    appendWord(image.height());
+    data.append(char(0));
+    data.append(char(8));
+
+    QByteArray codes;
+    quint32 bitBuffer = 0;
+    int bitCount = 0;
+    const auto writeCode = [&](const int code) {
+        bitBuffer |= quint32(code) << bitCount;
+        bitCount += 9;
+        while (bitCount >= 8)
+        {
+            codes.append(char(bitBuffer & 0xff));
+            bitBuffer >>= 8;
+            bitCount -= 8;
+        }
+    };
+
+    const int clearCode = 256;
+    const int endCode = 257;
+    int codesSinceClear = 0;
+    writeCode(clearCode);
+    for (int y = 0; y < image.height(); ++y)
+    {
+        const QRgb *line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+        for (int x = 0; x < image.width(); ++x)
+        {
+            if (codesSinceClear == 250)
+            {
+                writeCode(clearCode);
+                codesSinceClear = 0;
+            }
+            writeCode(((qRed(line[x]) >> 5) << 5) | ((qGreen(line[x]) >> 5) << 2) | (qBlue(line[x]) >> 6));
+            codesSinceClear++;
+        }
+    }
+    writeCode(endCode);
+    if (bitCount > 0)
+        codes.append(char(bitBuffer & 0xff));
+
+    for (qsizetype i = 0; i < codes.size(); i += 255)
+    {
+        const qsizetype blockSize = qMin<qsizetype>(255, codes.size() - i);
+        data.append(char(blockSize));
+        data.append(codes.mid(i, blockSize));
+    }
+    data.append(char(0));
+    data.append(';');
+
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+static bool writeSvg(const QString &path, const QSize &size)
+{
+    QString svg = QString("<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%1\" height=\"%2\" viewBox=\"0 0 100 100\">\n").arg(size.width()).arg(size.height());
+    for (int i = 0; i < 200; ++i)
+    {
+        svg += QString("<circle cx=\"%1\" cy=\"%2\" r=\"%3\" fill=\"#%4\" fill-opacity=\"0.5\"/>\n")
+            .arg(i * 37 % 100).arg(i * 61 % 100).arg(2 + i % 13).arg(QString::number(0x404040 + i * 0x010305, 16).right(6));
+    }
+    svg += "</svg>\n";
+
+    QFile file(path);
+    return file.open(QIODevice::WriteOnly) && file.write(svg.toUtf8()) > 0;
+}
+
+void LoadingBenchmarks::initTestCase()
+{
+    QVERIFY(corpusDir.isValid());
+}
+
+void LoadingBenchmarks::cleanupTestCase()
+{
+    qInfo("Peak resident set size: %lld MB", getPeakResidentBytes() / (1024 * 1024));
+}
+
+QString LoadingBenchmarks::getCorpusImage(const QByteArray &format, const QSize &size)
+{
+    const QString name = QString("%1x%2.%3").arg(size.width()).arg(size.height()).arg(QString::fromLatin1(format));
+    if (const auto it = corpusImages.constFind(name); it != corpusImages.constEnd())
+        return it.value();
+
+    if (!QImageReader::supportedImageFormats().contains(format))
+        return {};
+
+    const QString path = corpusDir.filePath(name);
+    bool isWritten = false;
+    if (format == "gif")
+        isWritten = writeGif(path, createCorpusContent(size));
+    else if (format == "svg")
+        isWritten = writeSvg(path, size);
+    else if (QImageWriter::supportedImageFormats().contains(format))
+        isWritten = createCorpusContent(size).save(path, format.constData());
+
+    corpusImages.insert(name, isWritten ? path : QString());
+    return corpusImages.value(name);
+}
+
+QString LoadingBenchmarks::getCorpusFolder(const int fileCount)
+{
+    if (const auto it = corpusFolders.constFind(fileCount); it != corpusFolders.constEnd())
+        return it.value();
+
+    // Every file is a copy of the same small image, since it's the folder size being measured
+    const QString folderPath = corpusDir.filePath(QString("folder-%1").arg(fileCount));
+    const QString sourcePath = getCorpusImage("png", QSize(64, 64));
+    if (sourcePath.isEmpty() || !QDir().mkpath(folderPath))
+        return {};
+    for (int i = 0; i < fileCount; ++i)
+    {
+        if (!QFile::copy(sourcePath, QDir(folderPath).filePath(QString("image%1.png").arg(i, 6, 10, QChar('0')))))
+            return {};
+    }
+
+    corpusFolders.insert(fileCount, folderPath);
+    return folderPath;
+}
+
+void LoadingBenchmarks::benchmarkDecode_data()
+{
+    QTest::addColumn<QByteArray>("format");
+    QTest::addColumn<QSize>("size");
+
+    const QList<QByteArray> formats {"jpg", "png", "webp", "gif", "svg"};
+    const QList<QSize> sizes {{640, 480}, {1920, 1080}, {4000, 3000}};
+    for (const QByteArray &format : formats)
+    {
+        for (const QSize &size : sizes)
+            QTest::addRow("%s %dx%d", format.constData(), size.width(), size.height()) << format << size;
+    }
+}
+
+void LoadingBenchmarks::benchmarkDecode()
+{
+    QFETCH(QByteArray, format);
+    QFETCH(QSize, size);
+
+    const QString path = getCorpusImage(format, size);
+    if (path.isEmpty())
+        QSKIP("Format is not available in this Qt build");
+
+    QVImageLoader loader;
+    QSignalSpy readySpy(&loader, &QVImageLoader::imageReady);
+    double totalDecodeMs = 0.0;
+    int decodeCount = 0;
+
+    QBENCHMARK
+    {
+        readySpy.clear();
+        loader.requestImage(path, true);
+        QVERIFY(readySpy.wait(60000));
+        const auto result = qvariant_cast<QVImageLoader::Result>(readySpy.at(0).at(1));
+        QVERIFY(!result.errorData.has_value());
+        totalDecodeMs += result.timings.decodeMs;
+        decodeCount++;
+    }
+
+    qInfo("Decode latency: %.2f ms", totalDecodeMs / decodeCount);
+}
+
+void LoadingBenchmarks::benchmarkTimeToFirstPixel_data()
+{
+    QTest::addColumn<int>("fileCount");
+
+    for (const int fileCount : {10, 100, 1000, 10000, 100000})
+        QTest::addRow("%d files", fileCount) << fileCount;
+}
+
+void LoadingBenchmarks::benchmarkTimeToFirstPixel()
+{
+    QFETCH(int, fileCount);
+
+    const QString folderPath = getCorpusFolder(fileCount);
+    QVERIFY(!folderPath.isEmpty());
+    const QString target = QDir(folderPath).filePath(QString("image%1.png").arg(fileCount / 2, 6, 10, QChar('0')));
+
+    // Includes enumerating the folder, which is part of what the user waits for when opening a file
+    QThreadPool::globalInstance()->waitForDone();
+    QBENCHMARK_ONCE
+    {
+        QVImageCore core;
+        QSignalSpy changedSpy(&core, &QVImageCore::fileChanged);
+        core.loadFile(target);
+        if (changedSpy.isEmpty())
+            QVERIFY(changedSpy.wait(60000));
+        QVERIFY(core.getCurrentFileDetails().isPixmapLoaded);
+    }
+    QThreadPool::globalInstance()->waitForDone();
+}
+
+void LoadingBenchmarks::benchmarkPreloadHitRate_data()
+{
+    QTest::addColumn<int>("navigationIntervalMs");
+
+    QTest::addRow("held key") << 0;
+    QTest::addRow("paced") << 100;
+    QTest::addRow("reading") << 500;
+}
+
+void LoadingBenchmarks::benchmarkPreloadHitRate()
+{
+    QFETCH(int, navigationIntervalMs);
+
+    // Distinct files of a realistic size, so that preloading has actual work to get ahead of
+    const QString sourcePath = getCorpusImage("jpg", QSize(4000, 3000));
+    if (sourcePath.isEmpty())
+        QSKIP("JPEG is not available in this Qt build");
+    const QString folderPath = corpusDir.filePath(QString("navigation-%1").arg(navigationIntervalMs));
+    QVERIFY(QDir().mkpath(folderPath));
+    const int fileCount = 30;
+    for (int i = 0; i < fileCount; ++i)
+        QVERIFY(QFile::copy(sourcePath, QDir(folderPath).filePath(QString("image%1.jpg").arg(i, 3, 10, QChar('0')))));
+
+    QThreadPool::globalInstance()->waitForDone();
+    QVImageCore core;
+    QSignalSpy changedSpy(&core, &QVImageCore::fileChanged);
+    core.loadFile(QDir(folderPath).filePath("image000.jpg"));
+    if (changedSpy.isEmpty())
+        QVERIFY(changedSpy.wait(60000));
+
+    const QVImageLoader::Stats initialStats = core.getLoaderStats();
+    QBENCHMARK_ONCE
+    {
+        for (int i = 1; i < fileCount; ++i)
+        {
+            if (navigationIntervalMs > 0)
+                QTest::qWait(navigationIntervalMs);
+            changedSpy.clear();
+            core.goToFile(Qv::GoToFileMode::Next);
+            if (changedSpy.isEmpty())
+                QVERIFY(changedSpy.wait(60000));
+        }
+    }
+
+    const QVImageLoader::Stats stats = core.getLoaderStats();
+    const quint64 requestCount = stats.requestCount - initialStats.requestCount;
+    const quint64 cachedCount = stats.cachedRequestCount - initialStats.cachedRequestCount;
+    const quint64 loadingCount = stats.loadingRequestCount - initialStats.loadingRequestCount;
+    qInfo("Preload hit rate: %llu of %llu ready, %llu in progress", cachedCount, requestCount, loadingCount);
+    QThreadPool::globalInstance()->waitForDone();
+}
+
+void FileEnumeratorBenchmarks::initTestCase()
+{
+    QVERIFY(treeDir.isValid());
+
+    QSettings settings;
+    settings.beginGroup("options");
+    originalAllowMimeContentDetection = settings.value("allowmimecontentdetection");
+}
+
+void FileEnumeratorBenchmarks::cleanupTestCase()
+{
+    QSettings settings;
+    settings.beginGroup("options");
+    if (originalAllowMimeContentDetection.isValid())
+        settings.setValue("allowmimecontentdetection", originalAllowMimeContentDetection);
+    else
+        settings.remove("allowmimecontentdetection");
+    qvApp->getSettingsManager().loadSettings();
+}
+
+QString FileEnumeratorBenchmarks::getTree(const int fileCount, const bool isRecursive)
+{
+    const QString name = QString("%1-%2").arg(isRecursive ? "nested" : "flat").arg(fileCount);
+    if (const auto it = trees.constFind(name); it != trees.constEnd())
+        return it.value();
+
+    // Mostly images, plus files the enumerator has to reject and extensionless images that only
+    // content detection can identify. Only the first bytes matter for detection, but sizes vary
+    // so sorting by size has something to do.
+    struct Entry
+    {
+        const char *suffix;
+        QByteArray header;
+    };
+    const QList<Entry> entries {
+        {".jpg", QByteArray::fromHex("ffd8ffe0")},
+        {".png", QByteArray::fromHex("89504e470d0a1a0a")},
+        {".gif", QByteArray("GIF89a")},
+        {".webp", QByteArray("RIFF\0\0\0\0WEBPVP8 ", 16)},
+        {".jpeg", QByteArray::fromHex("ffd8ffe1")},
+        {".PNG", QByteArray::fromHex("89504e470d0a1a0a")},
+        {".txt", QByteArray("notes")},
+        {".json", QByteArray("{}")},
+        {"", QByteArray::fromHex("89504e470d0a1a0a")},
+        {"", QByteArray("plain text")}
+    };
+    const int filesPerFolder = 100;
+
+    const QString rootPath = treeDir.filePath(name);
+    if (!QDir().mkpath(rootPath))
+        return {};
+    for (int i = 0; i < fileCount; ++i)
+    {
+        const QString folderPath = isRecursive ? QDir(rootPath).filePath(QString("folder%1").arg(i / filesPerFolder, 4, 10, QChar('0'))) : rootPath;
+        if (isRecursive && i % filesPerFolder == 0 && !QDir().mkpath(folderPath))
+            return {};
+
+        const Entry &entry = entries.at(i % entries.size());
+        QFile file(QDir(folderPath).filePath(QString("file %1%2").arg(i).arg(QString::fromLatin1(entry.suffix))));
+        if (!file.open(QIODevice::WriteOnly) || file.write(entry.header + QByteArray(i % 4096, '\0')) < 0)
+            return {};
+    }
+
+    if (isRecursive)
+    {
+        QFile marker(QDir(rootPath).filePath("qv-recurse.txt"));
+        if (!marker.open(QIODevice::WriteOnly))
+            return {};
+    }
+
+    trees.insert(name, rootPath);
+    return rootPath;
+}
+
+void FileEnumeratorBenchmarks::benchmarkGetCompatibleFiles_data()
+{
+    QTest::addColumn<int>("fileCount");
+    QTest::addColumn<Qv::SortMode>("sortMode");
+    QTest::addColumn<bool>("allowMimeContentDetection");
+    QTest::addColumn<bool>("isRecursive");
+
+    const QList<QPair<Qv::SortMode, const char*>> sortModes {
+        {Qv::SortMode::Name, "name"},
+        {Qv::SortMode::DateModified, "date modified"},
+        {Qv::SortMode::DateCreated, "date created"},
+        {Qv::SortMode::Size, "size"},
+        {Qv::SortMode::Type, "type"},
+        {Qv::SortMode::Random, "random"}
+    };
+    for (const int fileCount : {1000, 10000, 100000})
+    {
+        for (const auto &sortMode : sortModes)
+        {
+            for (const bool allowMimeContentDetection : {false, true})
+            {
+                for (const bool isRecursive : {false, true})
+                {
+                    QTest::addRow("%d files, %s%s%s", fileCount, sortMode.second,
+                                  allowMimeContentDetection ? ", content detection" : "",
+                                  isRecursive ? ", recursive" : "")
+                        << fileCount << sortMode.first << allowMimeContentDetection << isRecursive;
+                }
+            }
+        }
+    }
+}
+
+void FileEnumeratorBenchmarks::benchmarkGetCompatibleFiles()
+{
+    QFETCH(int, fileCount);
+    QFETCH(Qv::SortMode, sortMode);
+    QFETCH(bool, allowMimeContentDetection);
+    QFETCH(bool, isRecursive);
+
+    const QString rootPath = getTree(fileCount, isRecursive);
+    QVERIFY(!rootPath.isEmpty());
+
+    {
+        QSettings settings;
+        settings.beginGroup("options");
+        settings.setValue("allowmimecontentdetection", allowMimeContentDetection);
+    }
+    qvApp->getSettingsManager().loadSettings();
+
+    QVFileEnumerator enumerator;
+    enumerator.setSortMode(sortMode);
+    enumerator.setSortDescending(false);
+
+    QVFileEnumerator::CompatibleFileList files;
+    QBENCHMARK
+    {
+        files = enumerator.getCompatibleFiles(rootPath);
+    }
+
+    QCOMPARE(files.getIsRecursive(), isRecursive);
+    QVERIFY(!files.isEmpty());
+}
+
+int main(int argc, char *argv[])
+{
+    QVApplication app(argc, argv);
+    qRegisterMetaType<QVImageLoader::Result>();
+
+    LoadingBenchmarks loadingBenchmarks;
+    FileEnumeratorBenchmarks fileEnumeratorBenchmarks;
+    int result = QTest::qExec(&loadingBenchmarks, argc, argv);
+    result |= QTest::qExec(&fileEnumeratorBenchmarks, argc, argv);
+    return result;
+}
+
+#include "tst_qviewbenchmarks.moc"
@@ -3,6 +3,12 @@ VERSION = 8.0
 
 QT += core gui network widgets svg
 
+# Optional hardware accelerated viewport
+qtHaveModule(openglwidgets) {
+    QT += openglwidgets
+    DEFINES += OPENGL_LOADED
+}
+
 TEMPLATE = app
 
 QMAKE_PROJECT_DEPTH = 0
@@ -3,6 +3,7 @@
 #include "qvcocoafunctions.h"
 #include "openwith.h"
 #include "qvmenu.h"
+#include "qvtrace.h"
 
 #include <QSettings>
 #include <QActionGroup>
@@ -12,9 +13,11 @@
 
 ActionManager::ActionManager(QObject *parent) : QObject(parent)
 {
+    QVTraceScope traceScope("ActionManager::ActionManager");
+
     // Connect to settings signal
     connect(&qvApp->getSettingsManager(), &SettingsManager::settingsUpdated, this, &ActionManager::settingsUpdated);
-    settingsUpdated();
+    settingsUpdated(qvApp->getSettingsManager().getAllKeys());
 
     initializeActionLibrary();
 
@@ -36,8 +39,11 @@ ActionManager::~ActionManager()
     qDeleteAll(actionLibrary);
 }
 
-void ActionManager::settingsUpdated()
+void ActionManager::settingsUpdated(const QSet<QString> &changedKeys)
 {
+    if (!changedKeys.contains("saverecents"))
+        return;
+
     isSaveRecentsEnabled = qvApp->getSettingsManager().getBoolean("saverecents");
 
     auto const recentsMenus = menuCloneLibrary.values("recents");
@@ -321,6 +327,7 @@ QMenu *ActionManager::buildToolsMenu(QWidget *parent)
     addCloneOfAction(toolsMenu, "increasespeed");
     toolsMenu->addSeparator();
     addCloneOfAction(toolsMenu, "slideshow");
+    addCloneOfAction(toolsMenu, "performanceoverlay");
     addCloneOfAction(toolsMenu, "options");
 
     menuCloneLibrary.insert(toolsMenu->menuAction()->data().toString(), toolsMenu);
@@ -377,7 +384,7 @@ QMenu *ActionManager::buildRecentsMenu(QWidget *parent)
     menuCloneLibrary.insert(recentsMenu->menuAction()->data().toString(), recentsMenu);
     updateRecentsMenu();
     // update settings whenever recent menu is created so it can possibly be hidden
-    settingsUpdated();
+    settingsUpdated({"saverecents"});
     return recentsMenu;
 }
 
@@ -757,6 +764,8 @@ void ActionManager::actionTriggered(QAction *triggeredAction, MainWindow *releva
         relevantWindow->increaseSpeed();
     } else if (key == "slideshow") {
         relevantWindow->toggleSlideshow();
+    } else if (key == "performanceoverlay") {
+        relevantWindow->togglePerformanceOverlay();
     } else if (key.startsWith("sortmode")) {
         relevantWindow->setSortMode(static_cast<Qv::SortMode>(key.mid(QString("sortmode").length()).toInt()));
     } else if (key.startsWith("sortdirection")) {
@@ -790,7 +799,7 @@ void ActionManager::initializeActionLibrary()
     actionLibrary.insert("openurl", openUrlAction);
 
     auto *reloadFileAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::Refresh), tr("Re&load File"));
-    reloadFileAction->setData({"disable"});
+    reloadFileAction->setData({"filedisable"});
     actionLibrary.insert("reloadfile", reloadFileAction);
 
     auto *closeWindowAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::Close), tr("Close Window"));
@@ -808,22 +817,22 @@ void ActionManager::initializeActionLibrary()
     //: Open containing folder on macOS
     openContainingFolderAction->setText(tr("Show in &Finder"));
 #endif
-    openContainingFolderAction->setData({"disable"});
+    openContainingFolderAction->setData({"filedisable"});
     actionLibrary.insert("opencontainingfolder", openContainingFolderAction);
 
     auto *showFileInfoAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::Ballot), tr("Show File &Info"));
-    showFileInfoAction->setData({"disable"});
+    showFileInfoAction->setData({"filedisable"});
     actionLibrary.insert("showfileinfo", showFileInfoAction);
 
     auto *deleteAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::Delete), tr("&Move to Trash"));
 #ifdef Q_OS_WIN
     deleteAction->setText(tr("&Delete"));
 #endif
-    deleteAction->setData({"disable"});
+    deleteAction->setData({"filedisable"});
     actionLibrary.insert("delete", deleteAction);
 
     auto *deletePermanentAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::DeleteForever), tr("Delete Permanently"));
-    deletePermanentAction->setData({"disable"});
+    deletePermanentAction->setData({"filedisable"});
     actionLibrary.insert("deletepermanent", deletePermanentAction);
 
     auto *undoAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::RestoreFromTrash), tr("&Restore from Trash"));
@@ -834,14 +843,14 @@ void ActionManager::initializeActionLibrary()
     actionLibrary.insert("undo", undoAction);
 
     auto *copyAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::ContentCopy), tr("&Copy"));
-    copyAction->setData({"disable"});
+    copyAction->setData({"filedisable"});
     actionLibrary.insert("copy", copyAction);
 
     auto *pasteAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::ContentPaste), tr("&Paste"));
     actionLibrary.insert("paste", pasteAction);
 
     auto *renameAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::DriveFileRenameOutline), tr("R&ename..."));
-    renameAction->setData({"disable"});
+    renameAction->setData({"filedisable"});
     actionLibrary.insert("rename", renameAction);
 
     auto *zoomInAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::ZoomIn), tr("Zoom &In"));
@@ -965,6 +974,11 @@ void ActionManager::initializeActionLibrary()
     slideshowAction->setData({"disable"});
     actionLibrary.insert("slideshow", slideshowAction);
 
+    auto *performanceOverlayAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::WorkHistory), tr("Performance &Overlay"));
+    performanceOverlayAction->setData({"windowdisable"});
+    performanceOverlayAction->setCheckable(true);
+    actionLibrary.insert("performanceoverlay", performanceOverlayAction);
+
     //: This is for the options dialog on windows
     auto *optionsAction = new QAction(qvApp->iconFromFont(Qv::MaterialIcon::Settings), tr("&Settings"));
 #ifdef Q_OS_MACOS
@@ -74,7 +74,7 @@ public:
     explicit ActionManager(QObject *parent = nullptr);
     ~ActionManager() override;
 
-    void settingsUpdated();
+    void settingsUpdated(const QSet<QString> &changedKeys);
 
     QAction *addCloneOfAction(QWidget *parent, const QString &key);
 
@@ -1,11 +1,41 @@
 #include "mainwindow.h"
 #include "qvapplication.h"
+#include "qvimagecore.h"
+#include "qvsingleinstance.h"
+#include "qvtrace.h"
 #ifdef Q_OS_WIN
 #include "qvwindows11style.h"
 #endif
 
 #include <QCommandLineParser>
 #include <QFontDatabase>
+#include <QSettings>
+
+#ifdef WIN32_LOADED
+#include <qt_windows.h>
+#include <shellapi.h>
+#endif
+
+#ifndef Q_OS_MACOS
+static QStringList getArguments(int argc, char *argv[])
+{
+    QStringList arguments;
+#ifdef WIN32_LOADED
+    // argv is in the ANSI code page, which can't represent every file name
+    int wideArgumentCount {0};
+    if (LPWSTR *wideArguments = CommandLineToArgvW(GetCommandLineW(), &wideArgumentCount))
+    {
+        for (int i = 0; i < wideArgumentCount; ++i)
+            arguments << QString::fromWCharArray(wideArguments[i]);
+        LocalFree(wideArguments);
+        return arguments;
+    }
+#endif
+    for (int i = 0; i < argc; ++i)
+        arguments << QString::fromLocal8Bit(argv[i]);
+    return arguments;
+}
+#endif
 
 int main(int argc, char *argv[])
 {
@@ -15,6 +45,44 @@ int main(int argc, char *argv[])
 
     SettingsManager::migrateOldSettings();
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument(QObject::tr("file"), QObject::tr("The file to open."));
+    const QCommandLineOption traceOption("trace", QObject::tr("Write a Chrome trace of image loading to <file>."), QObject::tr("file"));
+    parser.addOption(traceOption);
+
+    QString traceFilePath = qEnvironmentVariable("QVIEW_TRACE_FILE");
+
+#ifndef Q_OS_MACOS
+    // Hand the file to an instance that's already running, if there is one listening, before
+    // paying for a full startup. macOS already does this for us via file open events.
+    if (QSettings().value("options/singleinstance", false).toBool())
+    {
+        const bool isParsed = parser.parse(getArguments(argc, argv));
+        if (isParsed && parser.isSet(traceOption))
+            traceFilePath = parser.value(traceOption);
+
+        if (isParsed && !parser.isSet("help") && !parser.isSet("version") && traceFilePath.isEmpty())
+        {
+            QStringList files;
+            if (!parser.positionalArguments().isEmpty())
+            {
+                const QString file = parser.positionalArguments().constFirst();
+                const QUrl fileUrl(file);
+                files << QFileInfo(fileUrl.isLocalFile() ? fileUrl.toLocalFile() : file).absoluteFilePath();
+            }
+            if (QVSingleInstance::forwardToRunningInstance(files))
+                return 0;
+        }
+    }
+#endif
+
+    // Start as early as possible so the trace covers startup
+    if (!traceFilePath.isEmpty())
+        QVTrace::start(traceFilePath);
+    QVTrace::instant("main");
+
     QString defaultStyleName;
 #if defined Q_OS_WIN && QT_VERSION >= QT_VERSION_CHECK(6, 8, 1)
     // windows11 style works on Windows 10 too if the right font is available
@@ -46,12 +114,17 @@ int main(int argc, char *argv[])
         QApplication::setStyle(new QvWindows11Style(QApplication::style()));
 #endif
 
-    QCommandLineParser parser;
-    parser.addHelpOption();
-    parser.addVersionOption();
-    parser.addPositionalArgument(QObject::tr("file"), QObject::tr("The file to open."));
     parser.process(app);
 
+    // Without the early parse, the option is only known now
+    if (!QVTrace::isEnabled() && parser.isSet(traceOption))
+        QVTrace::start(parser.value(traceOption));
+
+    // Get the image decoding while the window is being built
+    if (!parser.positionalArguments().isEmpty())
+        QVImageCore::prefetchFile(parser.positionalArguments().constFirst());
+
+    const double windowTraceStart = QVTrace::now();
     if (!parser.positionalArguments().isEmpty())
     {
         QVApplication::openFile(QVApplication::newWindow(), parser.positionalArguments().constFirst(), true);
@@ -60,6 +133,9 @@ int main(int argc, char *argv[])
     {
         QVApplication::newWindow();
     }
+    QVTrace::complete("main: first window", windowTraceStart);
 
-    return QApplication::exec();
+    const int result = QApplication::exec();
+    QVTrace::stop();
+    return result;
 }
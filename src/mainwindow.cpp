@@ -6,6 +6,8 @@
 #include "qvrenamedialog.h"
 #include "qvmenu.h"
 #include "qvmovie.h"
+#include "qvtrace.h"
+#include "qvurldownloader.h"
 
 #include <QFileDialog>
 #include <QMessageBox>
@@ -31,9 +33,6 @@
 #include <QtConcurrent/QtConcurrentRun>
 #include <QMenu>
 #include <QWindow>
-#include <QNetworkRequest>
-#include <QNetworkReply>
-#include <QTemporaryFile>
 #include <QLabel>
 #include <QGraphicsOpacityEffect>
 #include <QPropertyAnimation>
@@ -64,6 +63,8 @@ MainWindow::MainWindow(QWidget *parent, const QJsonObject &windowSessionState) :
     QMainWindow(parent),
     ui(new Ui::MainWindow)
 {
+    QVTraceScope traceScope("MainWindow::MainWindow");
+
     ui->setupUi(this);
     setAttribute(Qt::WA_DeleteOnClose);
     setAttribute(Qt::WA_OpaquePaintEvent);
@@ -140,6 +141,7 @@ MainWindow::MainWindow(QWidget *parent, const QJsonObject &windowSessionState) :
 
     // Context menu
     auto &actionManager = qvApp->getActionManager();
+    const double menuTraceStart = QVTrace::now();
 
     contextMenu = new QVMenu(this);
     contextMenu->setProperty("isContextMenu", true);
@@ -194,6 +196,7 @@ MainWindow::MainWindow(QWidget *parent, const QJsonObject &windowSessionState) :
     connect(virtualMenu, &QMenu::triggered, this, [this](QAction *triggeredAction){
         ActionManager::actionTriggered(triggeredAction, this);
     });
+    QVTrace::complete("MainWindow: menus", menuTraceStart);
 
     // Enable actions related to having a window
     disableActions();
@@ -201,7 +204,7 @@ MainWindow::MainWindow(QWidget *parent, const QJsonObject &windowSessionState) :
     // Connect functions to application components
     connect(&qvApp->getShortcutManager(), &ShortcutManager::shortcutsUpdated, this, &MainWindow::shortcutsUpdated);
     connect(&qvApp->getSettingsManager(), &SettingsManager::settingsUpdated, this, &MainWindow::settingsUpdated);
-    settingsUpdated();
+    settingsUpdated(qvApp->getSettingsManager().getAllKeys());
     shortcutsUpdated();
 
     // Timer for delayed-load Open With menu
@@ -338,7 +341,15 @@ void MainWindow::paintEvent(QPaintEvent *event)
     Q_UNUSED(event);
 
     QPainter painter(this);
+    paintBackground(painter);
+
+    // An empty window is all there is to show, otherwise the view reports its first paint
+    if (!hasFileOrPendingLoad())
+        qvApp->finishStartup();
+}
 
+void MainWindow::paintBackground(QPainter &painter) const
+{
     const ViewportPosition viewportPos = getViewportPosition();
     const int adjustedViewportY = viewportPos.widgetY + viewportPos.obscuredHeight;
     const QRect headerRect = QRect(0, 0, width(), adjustedViewportY);
@@ -346,7 +357,7 @@ void MainWindow::paintEvent(QPaintEvent *event)
 
     if (headerRect.isValid())
     {
-        painter.eraseRect(headerRect);
+        painter.fillRect(headerRect, palette().brush(backgroundRole()));
     }
 
     if (viewportRect.isValid())
@@ -375,7 +386,7 @@ void MainWindow::paintEvent(QPaintEvent *event)
         }
         else
         {
-            const QColor &backgroundColor = customBackgroundColor.isValid() ? customBackgroundColor : painter.background().color();
+            const QColor &backgroundColor = customBackgroundColor.isValid() ? customBackgroundColor : palette().color(backgroundRole());
             painter.fillRect(viewportRect, backgroundColor);
 
             if (getCurrentFileDetails().errorData.has_value())
@@ -401,7 +412,7 @@ void MainWindow::fullscreenChanged()
         fullscreenAction->setIcon(qvApp->iconFromFont(isFullscreen ? Qv::MaterialIcon::FullscreenExit : Qv::MaterialIcon::Fullscreen));
     }
 
-    ui->fullscreenLabel->setVisible(isFullscreen && qvApp->getSettingsManager().getBoolean("fullscreendetails"));
+    ui->fullscreenLabel->setVisible(isFullscreen && qvApp->getSettingsManager().getSnapshot().fullscreenDetails);
 
     if (!isFullscreen && storedTitlebarHidden)
     {
@@ -432,11 +443,12 @@ void MainWindow::openFile(const QString &fileName, const QString &baseDir)
     cancelSlideshow();
 }
 
-void MainWindow::settingsUpdated()
+void MainWindow::settingsUpdated(const QSet<QString> &changedKeys)
 {
     auto &settingsManager = qvApp->getSettingsManager();
 
-    buildWindowTitle();
+    if (changedKeys.contains("titlebarmode") || changedKeys.contains("customtitlebartext"))
+        buildWindowTitle();
 
     //bgcolor
     customBackgroundColor = settingsManager.getBoolean("bgcolorenabled") ? QColor(settingsManager.getString("bgcolor")) : QColor();
@@ -449,13 +461,15 @@ void MainWindow::settingsUpdated()
 
 #ifdef COCOA_LOADED
     // titlebaralwaysdark
-    QVCocoaFunctions::setVibrancy(settingsManager.getBoolean("titlebaralwaysdark"), windowHandle());
+    if (changedKeys.contains("titlebaralwaysdark"))
+        QVCocoaFunctions::setVibrancy(settingsManager.getBoolean("titlebaralwaysdark"), windowHandle());
 #endif
 
-    //slideshow timer
-    slideshowTimer->setInterval(static_cast<int>(settingsManager.getDouble("slideshowtimer")*1000));
+    //slideshow timer (setting the interval restarts a running slideshow, so leave it alone otherwise)
+    if (changedKeys.contains("slideshowtimer"))
+        slideshowTimer->setInterval(static_cast<int>(settingsManager.getDouble("slideshowtimer")*1000));
 
-    ui->fullscreenLabel->setVisible(qvApp->getSettingsManager().getBoolean("fullscreendetails") && windowState().testFlag(Qt::WindowFullScreen));
+    ui->fullscreenLabel->setVisible(settingsManager.getSnapshot().fullscreenDetails && windowState().testFlag(Qt::WindowFullScreen));
 
     updateMenuBarVisible();
 
@@ -559,6 +573,11 @@ void MainWindow::disableActions()
                 {
                     clone->setEnabled(getIsPixmapLoaded());
                 }
+                else if (cloneData.last() == "filedisable")
+                {
+                    // Pasted or dropped image data has no file to act on
+                    clone->setEnabled(getIsPixmapLoaded() && !getCurrentFileDetails().isInMemory);
+                }
                 else if (cloneData.last() == "gifdisable")
                 {
                     clone->setEnabled(getIsMovieLoaded());
@@ -582,9 +601,9 @@ void MainWindow::disableActions()
     const auto &openWithMenus = qvApp->getActionManager().getAllClonesOfMenu("openwith", this);
     for (const auto &menu : openWithMenus)
     {
-        menu->setEnabled(getIsPixmapLoaded());
+        menu->setEnabled(getIsPixmapLoaded() && !getCurrentFileDetails().isInMemory);
 #ifdef Q_OS_MACOS
-        menu->menuAction()->setVisible(getIsPixmapLoaded());
+        menu->menuAction()->setVisible(getIsPixmapLoaded() && !getCurrentFileDetails().isInMemory);
 #endif
     }
 
@@ -592,7 +611,7 @@ void MainWindow::disableActions()
     const auto &openWithPlaceholderActions = qvApp->getActionManager().getAllClonesOfAction("openwithplaceholder", this);
     for (const auto &action : openWithPlaceholderActions)
     {
-        action->setVisible(!getIsPixmapLoaded());
+        action->setVisible(!getIsPixmapLoaded() || getCurrentFileDetails().isInMemory);
     }
 #endif
 }
@@ -668,7 +687,8 @@ void MainWindow::buildWindowTitle()
         auto getImageWidth = [&]() { return QString::number(hasError ? 0 : fileDetails.baseImageSize.width()); };
         auto getImageHeight = [&]() { return QString::number(hasError ? 0 : fileDetails.baseImageSize.height()); };
         auto getFileSize = [&]() { return QVInfoDialog::formatBytes(hasError ? 0 : fileDetails.fileInfo.size()); };
-        switch (qvApp->getSettingsManager().getEnum<Qv::TitleBarText>("titlebarmode")) {
+        const SettingsManager::Snapshot &settings = qvApp->getSettingsManager().getSnapshot();
+        switch (settings.titleBarMode) {
         case Qv::TitleBarText::Minimal:
         {
             newString = getFileName();
@@ -688,7 +708,7 @@ void MainWindow::buildWindowTitle()
         case Qv::TitleBarText::Custom:
         {
             newString = "";
-            const QString customText = qvApp->getSettingsManager().getString("customtitlebartext");
+            const QString &customText = settings.customTitleBarText;
             for (int i = 0; i < customText.length(); i++)
             {
                 const QChar c = customText.at(i);
@@ -828,8 +848,10 @@ void MainWindow::setWindowSize(const bool isReapplying, const bool isExplicitReq
     if (!getIsPixmapLoaded())
         return;
 
+    const SettingsManager::Snapshot &settings = qvApp->getSettingsManager().getSnapshot();
+
     //check if the program is configured to resize the window
-    const auto windowResizeMode = qvApp->getSettingsManager().getEnum<Qv::WindowResizeMode>("windowresizemode");
+    const auto windowResizeMode = settings.windowResizeMode;
     const bool shouldResize =
         isExplicitRequest ||
         windowResizeMode == Qv::WindowResizeMode::WhenOpeningImages ||
@@ -843,8 +865,8 @@ void MainWindow::setWindowSize(const bool isReapplying, const bool isExplicitReq
     if (windowState().testFlag(Qt::WindowMaximized) || windowState().testFlag(Qt::WindowFullScreen))
         return;
 
-    const qreal minWindowResizedPercentage = qvApp->getSettingsManager().getInteger("minwindowresizedpercentage")/100.0;
-    const qreal maxWindowResizedPercentage = qvApp->getSettingsManager().getInteger("maxwindowresizedpercentage")/100.0;
+    const qreal minWindowResizedPercentage = settings.minWindowResizedPercentage/100.0;
+    const qreal maxWindowResizedPercentage = settings.maxWindowResizedPercentage/100.0;
 
     // Try to grab the current screen
     QScreen *currentScreen = screenContaining(frameGeometry());
@@ -889,7 +911,7 @@ void MainWindow::setWindowSize(const bool isReapplying, const bool isExplicitReq
 
     const bool recenterImage = isZoomFixed && geometry().size() != targetSize + extraWidgetsSize;
 
-    const auto afterMatchingSizeMode = qvApp->getSettingsManager().getEnum<Qv::AfterMatchingSize>("aftermatchingsizemode");
+    const auto afterMatchingSizeMode = settings.afterMatchingSizeMode;
     const QPoint referenceCenter =
         afterMatchingSizeMode == Qv::AfterMatchingSize::CenterOnPrevious ? geometry().center() :
         afterMatchingSizeMode == Qv::AfterMatchingSize::CenterOnScreen ? currentScreen->availableGeometry().center() :
@@ -955,7 +977,7 @@ const QJsonObject MainWindow::getSessionState() const
 
     state["titlebarHidden"] = getTitlebarHidden();
 
-    if (getIsPixmapLoaded())
+    if (getIsPixmapLoaded() && !getCurrentFileDetails().isInMemory)
     {
         state["path"] = getCurrentFileDetails().fileInfo.absoluteFilePath();
 
@@ -1006,8 +1028,7 @@ void MainWindow::openUrl(const QUrl &url)
         return;
     }
 
-    auto request = QNetworkRequest(url);
-    auto *reply = networkAccessManager.get(request);
+    auto *downloader = new QVUrlDownloader(&networkAccessManager, url, this);
     auto *progressDialog = new QProgressDialog(tr("Downloading image..."), tr("Cancel"), 0, 100);
     progressDialog->setWindowFlag(Qt::WindowContextHelpButtonHint, false);
     progressDialog->setAutoClose(false);
@@ -1015,52 +1036,40 @@ void MainWindow::openUrl(const QUrl &url)
     progressDialog->setWindowTitle(tr("Open URL..."));
     progressDialog->open();
 
-    connect(progressDialog, &QProgressDialog::canceled, reply, [reply]{
-        reply->abort();
-    });
-
-    connect(reply, &QNetworkReply::downloadProgress, progressDialog, [progressDialog](qreal bytesReceived, qreal bytesTotal){
-        auto percent = (bytesReceived/bytesTotal)*100;
-        progressDialog->setValue(qRound(percent));
-    });
+    connect(progressDialog, &QProgressDialog::canceled, downloader, &QVUrlDownloader::abort);
 
-    connect(reply, &QNetworkReply::finished, progressDialog, [progressDialog, reply, this]{
-        if (reply->error())
+    connect(downloader, &QVUrlDownloader::progress, progressDialog, [progressDialog](qint64 bytesReceived, qint64 bytesTotal){
+        // Servers don't always say how big the file is
+        if (bytesTotal <= 0)
         {
-            progressDialog->close();
-            QMessageBox::critical(this, tr("Error"), tr("Error ") + QString::number(reply->error()) + ": " + reply->errorString());
-
-            progressDialog->deleteLater();
+            progressDialog->setMaximum(0);
             return;
         }
+        progressDialog->setMaximum(100);
+        progressDialog->setValue(qRound(bytesReceived * 100.0 / bytesTotal));
+    });
 
-        progressDialog->setMaximum(0);
-
-        auto *tempFile = new QTemporaryFile(this);
-        tempFile->setFileTemplate(QDir::tempPath() + "/" + qvApp->applicationName() + ".XXXXXX.png");
+    connect(downloader, &QVUrlDownloader::finished, this, [progressDialog, downloader, this](const QString &errorString){
+        progressDialog->close();
+        progressDialog->deleteLater();
+        downloader->deleteLater();
 
-        auto *saveFutureWatcher = new QFutureWatcher<bool>();
-        connect(saveFutureWatcher, &QFutureWatcher<bool>::finished, this, [progressDialog, tempFile, saveFutureWatcher, this](){
-            progressDialog->close();
-            if (saveFutureWatcher->result())
-            {
-                if (tempFile->open())
-                {
-                    openFile(tempFile->fileName());
-                }
-            }
-            else
-            {
-                QMessageBox::critical(this, tr("Error"), tr("Error: Invalid image"));
-                tempFile->deleteLater();
-            }
-            progressDialog->deleteLater();
-            saveFutureWatcher->deleteLater();
-        });
+        if (!errorString.isEmpty())
+        {
+            QMessageBox::critical(this, tr("Error"), tr("Error ") + errorString);
+            return;
+        }
 
-        saveFutureWatcher->setFuture(QtConcurrent::run([reply, tempFile]{
-            return QImage::fromData(reply->readAll()).save(tempFile, "png");
-        }));
+        // Keep the file around for as long as the window might show it
+        if (auto *tempFile = downloader->takeFile())
+        {
+            tempFile->setParent(this);
+            openFile(tempFile->fileName());
+        }
+        else
+        {
+            QMessageBox::critical(this, tr("Error"), tr("Error: Invalid image"));
+        }
     });
 }
 
@@ -1126,7 +1135,7 @@ void MainWindow::showFileInfo()
 
 void MainWindow::askDeleteFile(bool permanent)
 {
-    if (!permanent && !qvApp->getSettingsManager().getBoolean("askdelete"))
+    if (!permanent && !qvApp->getSettingsManager().getSnapshot().askDelete)
     {
         deleteFile(permanent);
         return;
@@ -1209,7 +1218,7 @@ void MainWindow::deleteFile(bool permanent)
     qvApp->getActionManager().auditRecentsList(true);
     qvApp->invalidateFolderListings();
 
-    auto afterDelete = qvApp->getSettingsManager().getEnum<Qv::AfterDelete>("afterdelete");
+    const auto afterDelete = qvApp->getSettingsManager().getSnapshot().afterDelete;
     if (afterDelete == Qv::AfterDelete::MoveForward)
         nextFile();
     else if (afterDelete == Qv::AfterDelete::MoveBack)
@@ -1473,7 +1482,7 @@ void MainWindow::toggleSlideshow()
     }
     if (isStarting)
     {
-        slideshowSetOnTopFlag = qvApp->getSettingsManager().getBoolean("slideshowkeepswindowontop") && !getWindowOnTop();
+        slideshowSetOnTopFlag = qvApp->getSettingsManager().getSnapshot().slideshowKeepsWindowOnTop && !getWindowOnTop();
         if (slideshowSetOnTopFlag)
             toggleWindowOnTop();
     }
@@ -1492,7 +1501,7 @@ void MainWindow::cancelSlideshow()
 
 void MainWindow::slideshowAction()
 {
-    switch (qvApp->getSettingsManager().getEnum<Qv::SlideshowDirection>("slideshowdirection"))
+    switch (qvApp->getSettingsManager().getSnapshot().slideshowDirection)
     {
     case Qv::SlideshowDirection::Forward:
         nextFile();
@@ -1589,6 +1598,16 @@ void MainWindow::toggleTitlebarHidden()
     setTitlebarHidden(!getTitlebarHidden());
 }
 
+void MainWindow::togglePerformanceOverlay()
+{
+    const bool targetValue = !graphicsView->getPerformanceOverlayVisible();
+
+    graphicsView->setPerformanceOverlayVisible(targetValue);
+
+    for (const auto &action : qvApp->getActionManager().getAllClonesOfAction("performanceoverlay", this))
+        action->setChecked(targetValue);
+}
+
 int MainWindow::getTitlebarOverlap() const
 {
 #ifdef COCOA_LOADED
@@ -152,10 +152,14 @@ public:
 
     void toggleTitlebarHidden();
 
+    void togglePerformanceOverlay();
+
     int getTitlebarOverlap() const;
 
     ViewportPosition getViewportPosition() const;
 
+    void paintBackground(QPainter &painter) const;
+
     const QVImageCore::FileDetails& getCurrentFileDetails() const { return graphicsView->getCurrentFileDetails(); }
 
     bool hasFileOrPendingLoad() const { return graphicsView->hasFileOrPendingLoad(); }
@@ -209,7 +213,7 @@ protected:
     void pauseChanged();
 
 protected slots:
-    void settingsUpdated();
+    void settingsUpdated(const QSet<QString> &changedKeys);
     void shortcutsUpdated();
 
 private:
@@ -6,12 +6,17 @@
 #include "ui_qvopenwithdialog.h"
 
 #include <QCollator>
+#include <QCryptographicHash>
 #include <QDir>
 #include <QFileDialog>
 #include <QProcess>
 #include <QStandardPaths>
 #include <QMimeDatabase>
 #include <QSettings>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 
 #include <QDebug>
 
@@ -67,94 +72,249 @@ QList<OpenWith::OpenWithItem> OpenWith::getOpenWithItemsFromDesktopFiles(const Q
         mimeName = mime.name();
     }
 
-    // This should probably be async dude
-    QProcess process;
-    process.start("xdg-mime", {"query", "default", mimeName});
-    process.waitForFinished();
-    QString defaultApplication = process.readAllStandardOutput().trimmed();
+    const QList<DesktopEntry> entries = getDesktopEntries();
+    const QString defaultApplication = !mimeName.isEmpty() ? getDefaultDesktopEntryId(mimeName, entries) : QString();
 
+    for (const auto &entry : entries)
+    {
+        if (!mimeName.isEmpty() && !entry.mimeTypes.contains(mimeName, Qt::CaseInsensitive))
+            continue;
+
+        OpenWithItem openWithItem;
+        openWithItem.name = entry.name;
+        openWithItem.iconName = entry.iconName;
+        openWithItem.exec = entry.exec;
+        openWithItem.categories = entry.categories;
+        // If the program is the default program, save it to add to the beginning after sorting
+        openWithItem.isDefault = entry.id == defaultApplication;
+
+        listOfOpenWithItems.append(openWithItem);
+    }
+
+    return listOfOpenWithItems;
+}
+
+QList<OpenWith::DesktopEntry> OpenWith::getDesktopEntries()
+{
+    // Listing the files is much cheaper than parsing them, and unlike the folders' modification
+    // times it also catches entries edited in place, such as by a package upgrade
     const QStringList &applicationLocations = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
+    QCryptographicHash keyHash(QCryptographicHash::Sha1);
     for (const auto &location : applicationLocations)
+    {
+        keyHash.addData(location.toUtf8());
+        const auto &entryInfoList = QDir(location).entryInfoList({"*.desktop"}, QDir::Files, QDir::Name);
+        for (const auto &fileInfo : entryInfoList)
+            keyHash.addData(QString("\n%1|%2|%3").arg(fileInfo.fileName()).arg(fileInfo.lastModified().toMSecsSinceEpoch()).arg(fileInfo.size()).toUtf8());
+        keyHash.addData(QByteArray("\n\n"));
+    }
+    const QString key = QString::fromLatin1(keyHash.result().toHex());
+
+    QMutexLocker locker(&desktopEntryMutex);
+    if (key == desktopEntryKey)
+        return desktopEntries;
+
+    const QString cachePath = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("desktopentries.json");
+    QFile cacheFile(cachePath);
+    if (cacheFile.open(QIODevice::ReadOnly))
+    {
+        const QJsonObject cache = QJsonDocument::fromJson(cacheFile.readAll()).object();
+        if (cache.value("key").toString() == key)
+        {
+            QList<DesktopEntry> cachedEntries;
+            const QJsonArray entries = cache.value("entries").toArray();
+            for (const auto &value : entries)
+            {
+                const QJsonObject object = value.toObject();
+                cachedEntries.append({
+                    object.value("id").toString(),
+                    object.value("name").toString(),
+                    object.value("icon").toString(),
+                    object.value("exec").toString(),
+                    object.value("categories").toVariant().toStringList(),
+                    object.value("mimeTypes").toVariant().toStringList()
+                });
+            }
+            desktopEntryKey = key;
+            desktopEntries = cachedEntries;
+            return desktopEntries;
+        }
+        cacheFile.close();
+    }
+
+    desktopEntryKey = key;
+    desktopEntries = readDesktopEntries(applicationLocations);
+
+    QJsonArray entries;
+    for (const auto &entry : std::as_const(desktopEntries))
+    {
+        entries << QJsonObject {
+            {"id", entry.id},
+            {"name", entry.name},
+            {"icon", entry.iconName},
+            {"exec", entry.exec},
+            {"categories", QJsonArray::fromStringList(entry.categories)},
+            {"mimeTypes", QJsonArray::fromStringList(entry.mimeTypes)}
+        };
+    }
+    QDir().mkpath(QFileInfo(cachePath).path());
+    QSaveFile saveFile(cachePath);
+    if (saveFile.open(QIODevice::WriteOnly))
+    {
+        saveFile.write(QJsonDocument(QJsonObject {{"key", key}, {"entries", entries}}).toJson(QJsonDocument::Compact));
+        saveFile.commit();
+    }
+
+    return desktopEntries;
+}
+
+QList<OpenWith::DesktopEntry> OpenWith::readDesktopEntries(const QStringList &locations)
+{
+    QList<DesktopEntry> entries;
+    QSet<QString> seenIds;
+
+    for (const auto &location : locations)
     {
         auto dir = QDir(location);
-        const auto &entryInfoList = dir.entryInfoList();
+        const auto &entryInfoList = dir.entryInfoList({"*.desktop"}, QDir::Files);
         for (const auto &fileInfo : entryInfoList)
         {
             // Don't add qView to the open with menu!
             if (fileInfo.fileName() == "qView.desktop" || fileInfo.fileName() == "com.interversehq.qView.desktop")
                 continue;
 
-            if (!fileInfo.fileName().endsWith(".desktop"))
+            // Locations are in order of precedence, so e.g. a user's own copy hides the system one
+            if (seenIds.contains(fileInfo.fileName()))
                 continue;
+            seenIds.insert(fileInfo.fileName());
 
-            OpenWithItem openWithItem;
-            // additional info to hold
-            QString mimeTypes;
-            bool noDisplay = false;
+            if (const auto entry = readDesktopFile(fileInfo))
+                entries.append(entry.value());
+        }
+    }
 
-            QFile file(fileInfo.absoluteFilePath());
-            if (!file.open(QIODevice::ReadOnly))
-                continue;
-            QTextStream in(&file);
-            QString line;
-            while (in.readLineInto(&line))
+    return entries;
+}
+
+std::optional<OpenWith::DesktopEntry> OpenWith::readDesktopFile(const QFileInfo &fileInfo)
+{
+    DesktopEntry entry;
+    entry.id = fileInfo.fileName();
+    bool noDisplay = false;
+
+    QFile file(fileInfo.absoluteFilePath());
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    QTextStream in(&file);
+    QString line;
+    const auto hasKey = [&line](const QString &key) {
+        return line.startsWith(key + "=", Qt::CaseInsensitive);
+    };
+    const auto valueOf = [&line](const QString &key) {
+        return line.mid(key.length() + 1);
+    };
+
+    while (in.readLineInto(&line))
+    {
+        if (hasKey("Name") && entry.name.isEmpty())
+        {
+            entry.name = valueOf("Name");
+        }
+        else if (hasKey("Icon") && entry.iconName.isEmpty())
+        {
+            entry.iconName = valueOf("Icon");
+        }
+        else if (hasKey("Categories") && entry.categories.isEmpty())
+        {
+            entry.categories = valueOf("Categories").split(";");
+        }
+        else if (hasKey("Exec") && entry.exec.isEmpty())
+        {
+            QString exec = valueOf("Exec");
+            QRegularExpression regExp;
+            regExp.setPattern("%.*");
+            exec.remove(regExp);
+            entry.exec = exec;
+        }
+        else if (hasKey("MimeType") && entry.mimeTypes.isEmpty())
+        {
+            entry.mimeTypes = valueOf("MimeType").split(";", Qt::SkipEmptyParts);
+        }
+        else if (hasKey("NoDisplay") && !valueOf("NoDisplay").compare("true", Qt::CaseInsensitive))
+        {
+            noDisplay = true;
+        }
+        else if (hasKey("Hidden") && !valueOf("Hidden").compare("true", Qt::CaseInsensitive))
+        {
+            noDisplay = true;
+        }
+    }
+
+    if (noDisplay)
+        return {};
+
+    return entry;
+}
+
+QString OpenWith::getDefaultDesktopEntryId(const QString &mimeName, const QList<DesktopEntry> &entries)
+{
+    // Same lookup order as xdg-mime, without having to run it: desktop-specific lists before
+    // generic ones, config folders before data folders, and the first installed application wins
+    QStringList listPaths;
+    const QStringList currentDesktops = qEnvironmentVariable("XDG_CURRENT_DESKTOP").toLower().split(":", Qt::SkipEmptyParts);
+    const QStringList &configLocations = QStandardPaths::standardLocations(QStandardPaths::GenericConfigLocation);
+    for (const auto &location : configLocations)
+    {
+        for (const auto &desktop : currentDesktops)
+            listPaths << QDir(location).filePath(desktop + "-mimeapps.list");
+        listPaths << QDir(location).filePath("mimeapps.list");
+    }
+    const QStringList &applicationLocations = QStandardPaths::standardLocations(QStandardPaths::ApplicationsLocation);
+    for (const auto &location : applicationLocations)
+    {
+        for (const auto &desktop : currentDesktops)
+            listPaths << QDir(location).filePath(desktop + "-mimeapps.list");
+        listPaths << QDir(location).filePath("mimeapps.list");
+    }
+    // The legacy lists only count once none of the mimeapps.list files had an answer
+    for (const auto &location : applicationLocations)
+        listPaths << QDir(location).filePath("defaults.list");
+
+    QSet<QString> installedIds;
+    for (const auto &entry : entries)
+        installedIds.insert(entry.id);
+
+    for (const auto &listPath : std::as_const(listPaths))
+    {
+        QFile file(listPath);
+        if (!file.open(QIODevice::ReadOnly))
+            continue;
+
+        QTextStream in(&file);
+        QString line;
+        bool isDefaultsGroup = false;
+        while (in.readLineInto(&line))
+        {
+            line = line.trimmed();
+            if (line.startsWith("["))
             {
-                if (line.startsWith("Name=", Qt::CaseInsensitive) && openWithItem.name.isEmpty())
-                {
-                    line.remove("Name=", Qt::CaseInsensitive);
-                    openWithItem.name = line;
-                }
-                else if (line.startsWith("Icon=", Qt::CaseInsensitive) && openWithItem.icon.isNull())
-                {
-                    line.remove("Icon=", Qt::CaseInsensitive);
-                    openWithItem.iconName = line;
-                }
-                else if (line.startsWith("Categories=", Qt::CaseInsensitive) && openWithItem.categories.isEmpty())
-                {
-                    line.remove("Categories=", Qt::CaseInsensitive);
-                    openWithItem.categories = line.split(";");
-                }
-                else if (line.startsWith("Exec=", Qt::CaseInsensitive) && openWithItem.exec.isEmpty())
-                {
-                    line.remove("Exec=", Qt::CaseInsensitive);
-                    QRegularExpression regExp;
-                    regExp.setPattern("%.*");
-                    line.remove(regExp);
-                    openWithItem.exec = line;
-                }
-                else if (line.startsWith("MimeType=", Qt::CaseInsensitive) && mimeTypes.isEmpty())
-                {
-                    line.remove("MimeType=", Qt::CaseInsensitive);
-                    mimeTypes = line;
-                }
-                else if (line.startsWith("NoDisplay=", Qt::CaseInsensitive))
-                {
-                    line.remove("NoDisplay=");
-                    if (!line.compare("true", Qt::CaseInsensitive))
-                    {
-                        noDisplay = true;
-                    }
-                }
-                else if (line.startsWith("Hidden=", Qt::CaseInsensitive))
-                {
-                    line.remove("Hidden=");
-                    if (!line.compare("true", Qt::CaseInsensitive))
-                    {
-                        noDisplay = true;
-                    }
-                }
+                isDefaultsGroup = line == "[Default Applications]";
+                continue;
             }
-            if ((mimeTypes.contains(mimeName, Qt::CaseInsensitive) || mimeName.isEmpty()) && !noDisplay)
-            {
-                // If the program is the default program, save it to add to the beginning after sorting
-                openWithItem.isDefault = fileInfo.fileName() == defaultApplication;
+            if (!isDefaultsGroup || !line.startsWith(mimeName + "="))
+                continue;
 
-                listOfOpenWithItems.append(openWithItem);
+            const QStringList ids = line.mid(mimeName.length() + 1).split(";", Qt::SkipEmptyParts);
+            for (const auto &id : ids)
+            {
+                if (installedIds.contains(id))
+                    return id;
             }
         }
     }
 
-    return listOfOpenWithItems;
+    return {};
 }
 
 void OpenWith::showOpenWithDialog(QWidget *parent)
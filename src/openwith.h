@@ -1,8 +1,11 @@
 #ifndef OPENWITH_H
 #define OPENWITH_H
 
+#include <optional>
 #include <QIcon>
 #include <QDialog>
+#include <QFileInfo>
+#include <QMutex>
 #include <QAbstractButton>
 #include <QStandardItemModel>
 
@@ -32,6 +35,31 @@ public:
     static void openWith(const QString &filePath, const OpenWithItem &openWithItem);
 
     static QList<OpenWithItem> getOpenWithItemsFromDesktopFiles(const QString &filePath);
+
+protected:
+    struct DesktopEntry {
+        QString id;
+        QString name;
+        QString iconName;
+        QString exec;
+        QStringList categories;
+        QStringList mimeTypes;
+    };
+
+    static QList<DesktopEntry> getDesktopEntries();
+
+    static QList<DesktopEntry> readDesktopEntries(const QStringList &locations);
+
+    static std::optional<DesktopEntry> readDesktopFile(const QFileInfo &fileInfo);
+
+    static QString getDefaultDesktopEntryId(const QString &mimeName, const QList<DesktopEntry> &entries);
+
+private:
+    // Parsed .desktop files, shared by every window and kept on disk between launches. Only
+    // reread when one of the application folders changes.
+    static inline QMutex desktopEntryMutex;
+    static inline QString desktopEntryKey;
+    static inline QList<DesktopEntry> desktopEntries;
 };
 Q_DECLARE_METATYPE(OpenWith::OpenWithItem);
 
@@ -3,6 +3,7 @@
 #include "qvcocoafunctions.h"
 #include "simplefonticonengine.h"
 #include "updatechecker.h"
+#include "qvtrace.h"
 
 #include <QFileOpenEvent>
 #include <QSettings>
@@ -12,9 +13,16 @@
 #include <QPushButton>
 #include <QFontDatabase>
 #include <QStyleHints>
+#include <QStandardPaths>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QCryptographicHash>
 
 QVApplication::QVApplication(int &argc, char **argv) : QApplication(argc, argv)
 {
+    QVTraceScope traceScope("QVApplication::QVApplication");
+
 #if defined Q_OS_UNIX && !defined Q_OS_MACOS
     setDesktopFileName("com.interversehq.qView");
 
@@ -36,13 +44,13 @@ QVApplication::QVApplication(int &argc, char **argv) : QApplication(argc, argv)
     connect(&settingsManager, &SettingsManager::settingsUpdated, this, &QVApplication::settingsUpdated);
     connect(&actionManager, &ActionManager::recentsMenuUpdated, this, &QVApplication::recentsMenuUpdated);
     connect(&updateChecker, &UpdateChecker::checkedUpdates, this, &QVApplication::checkedUpdates);
+    connect(&singleInstance, &QVSingleInstance::filesReceived, this, &QVApplication::openForwardedFiles);
 
-    settingsUpdated();
+    settingsUpdated(settingsManager.getAllKeys());
 
-    // Check for updates
-    // TODO: move this to after first window show event
-    if (getSettingsManager().getBoolean("updatenotifications"))
-        updateChecker.check();
+    // Work that isn't needed to show the first image waits until it's on screen, or a little
+    // while in case that never happens (e.g. the first load failed)
+    QTimer::singleShot(deferredStartupFallbackMs, this, &QVApplication::finishStartup);
 
     showMainMenuIcons = getSettingsManager().getBoolean("mainmenuicons");
     showContextMenuIcons = getSettingsManager().getBoolean("contextmenuicons");
@@ -57,26 +65,28 @@ QVApplication::QVApplication(int &argc, char **argv) : QApplication(argc, argv)
     // Ask Qt to show menu icons - the action clone logic decides whether to actually set icons
     setAttribute(Qt::AA_DontShowIconsInMenus, false);
 
+#ifdef Q_OS_MACOS
+    const double menuTraceStart = QVTrace::now();
+
     // Setup macOS dock menu
     dockMenu = new QMenu();
     connect(dockMenu, &QMenu::triggered, this, [](QAction *triggeredAction){
         ActionManager::actionTriggered(triggeredAction);
     });
-
-    actionManager.loadRecentsList();
-
-#ifdef Q_OS_MACOS
     actionManager.addCloneOfAction(dockMenu, "newwindow");
     actionManager.addCloneOfAction(dockMenu, "open");
     dockMenu->setAsDockMenu();
-#endif
 
-    // Build menu bar
+    // Build menu bar, which is the global one while no window is open. Other platforms only
+    // have per-window menu bars, so there's no reason to spend time building this there.
     menuBar = actionManager.buildMenuBar();
     connect(menuBar, &QMenuBar::triggered, this, [](QAction *triggeredAction){
         ActionManager::actionTriggered(triggeredAction);
     });
 
+    QVTrace::complete("QVApplication: application menus", menuTraceStart);
+#endif
+
     // Set mac-specific application settings
 #ifdef COCOA_LOADED
     QVCocoaFunctions::setUserDefaults();
@@ -88,8 +98,10 @@ QVApplication::QVApplication(int &argc, char **argv) : QApplication(argc, argv)
 
 QVApplication::~QVApplication()
 {
-    dockMenu->deleteLater();
-    menuBar->deleteLater();
+    if (dockMenu)
+        dockMenu->deleteLater();
+    if (menuBar)
+        menuBar->deleteLater();
 }
 
 bool QVApplication::event(QEvent *event)
@@ -175,6 +187,41 @@ MainWindow *QVApplication::newWindow(const QJsonObject &windowSessionState)
     return w;
 }
 
+void QVApplication::openForwardedFiles(const QStringList &files)
+{
+    if (files.isEmpty())
+    {
+        newWindow();
+        return;
+    }
+
+    bool reuseWindow = getSettingsManager().getBoolean("reusewindow");
+    for (const auto &file : files)
+    {
+        MainWindow *window = getMainWindow(!reuseWindow);
+        openFile(window, file);
+        window->raise();
+        window->activateWindow();
+    }
+}
+
+void QVApplication::finishStartup()
+{
+    if (isStartupFinished)
+        return;
+
+    isStartupFinished = true;
+    QVTrace::instant("QVApplication::finishStartup");
+
+    // Let the frame that triggered this get presented first
+    QTimer::singleShot(0, this, [this]{
+        QVTraceScope traceScope("QVApplication: deferred startup");
+
+        if (getSettingsManager().getBoolean("updatenotifications"))
+            updateChecker.check();
+    });
+}
+
 MainWindow *QVApplication::getMainWindow(bool shouldBeEmpty)
 {
     MainWindow *foundWindow = nullptr;
@@ -322,22 +369,29 @@ void QVApplication::hideIncompatibleActions()
 {
 }
 
-void QVApplication::settingsUpdated()
+void QVApplication::settingsUpdated(const QSet<QString> &changedKeys)
 {
     auto &settingsManager = getSettingsManager();
 
-    QString disabledFileExtensionsStr = settingsManager.getString("disabledfileextensions");
-    disabledFileExtensions = Qv::listToSet(!disabledFileExtensionsStr.isEmpty() ? disabledFileExtensionsStr.split(';') : QStringList());
-
 #ifdef Q_OS_MACOS
     setQuitOnLastWindowClosed(settingsManager.getBoolean("quitonlastwindow"));
+#else
+    singleInstance.setListening(settingsManager.getBoolean("singleinstance"));
 #endif
 
+    if (!changedKeys.contains("disabledfileextensions"))
+        return;
+
+    QString disabledFileExtensionsStr = settingsManager.getString("disabledfileextensions");
+    disabledFileExtensions = Qv::listToSet(!disabledFileExtensionsStr.isEmpty() ? disabledFileExtensionsStr.split(';') : QStringList());
+
     defineFilterLists();
 }
 
 void QVApplication::defineFilterLists()
 {
+    QVTraceScope traceScope("QVApplication::defineFilterLists");
+
     allFileExtensionSet.clear();
     fileExtensionSet.clear();
     mimeTypeNameSet.clear();
@@ -352,8 +406,11 @@ void QVApplication::defineFilterLists()
         fileExtensionSet << extension;
     };
 
+    if (!supportedImageFormats.has_value())
+        supportedImageFormats = loadSupportedImageFormats();
+
     // Build extension list
-    const auto &byteArrayFormats = QImageReader::supportedImageFormats();
+    const auto &byteArrayFormats = supportedImageFormats->formats;
     for (const auto &byteArray : byteArrayFormats)
     {
         const auto fileExtension = "." + QString::fromUtf8(byteArray);
@@ -387,7 +444,7 @@ void QVApplication::defineFilterLists()
     }
 
     // Build mime type list
-    const auto &byteArrayMimeTypes = QImageReader::supportedMimeTypes();
+    const auto &byteArrayMimeTypes = supportedImageFormats->mimeTypes;
     for (const auto &byteArray : byteArrayMimeTypes)
     {
         const QString mimeType = QString::fromUtf8(byteArray);
@@ -412,6 +469,75 @@ void QVApplication::defineFilterLists()
     nameFilterList << tr("All Files") + " (*)";
 }
 
+QVApplication::SupportedImageFormats QVApplication::loadSupportedImageFormats()
+{
+    // Asking QImageReader means reading the metadata of every image plugin, which adds up on
+    // installs with a lot of them, so the lists are kept on disk until the plugins change
+    const QString cacheKey = getImageFormatCacheKey();
+    const QString cachePath = QDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("imageformats.json");
+
+    QFile cacheFile(cachePath);
+    if (cacheFile.open(QIODevice::ReadOnly))
+    {
+        const QJsonObject cache = QJsonDocument::fromJson(cacheFile.readAll()).object();
+        if (cache.value("key").toString() == cacheKey)
+        {
+            SupportedImageFormats cached;
+            const QJsonArray formats = cache.value("formats").toArray();
+            for (const auto &format : formats)
+                cached.formats << format.toString().toUtf8();
+            const QJsonArray mimeTypes = cache.value("mimeTypes").toArray();
+            for (const auto &mimeType : mimeTypes)
+                cached.mimeTypes << mimeType.toString().toUtf8();
+            if (!cached.formats.isEmpty())
+                return cached;
+        }
+        cacheFile.close();
+    }
+
+    SupportedImageFormats result {QImageReader::supportedImageFormats(), QImageReader::supportedMimeTypes()};
+
+    QJsonArray formats;
+    for (const auto &format : std::as_const(result.formats))
+        formats << QString::fromUtf8(format);
+    QJsonArray mimeTypes;
+    for (const auto &mimeType : std::as_const(result.mimeTypes))
+        mimeTypes << QString::fromUtf8(mimeType);
+    const QJsonObject cache {
+        {"key", cacheKey},
+        {"formats", formats},
+        {"mimeTypes", mimeTypes}
+    };
+
+    QDir().mkpath(QFileInfo(cachePath).path());
+    QSaveFile saveFile(cachePath);
+    if (saveFile.open(QIODevice::WriteOnly))
+    {
+        saveFile.write(QJsonDocument(cache).toJson(QJsonDocument::Compact));
+        saveFile.commit();
+    }
+
+    return result;
+}
+
+QString QVApplication::getImageFormatCacheKey()
+{
+    // Listing the plugin folders is much cheaper than loading what's in them, and catches
+    // plugins being added, removed or replaced
+    QStringList keyParts {
+        QString::fromLatin1(qVersion()),
+        QString::number(QFileInfo(QCoreApplication::applicationFilePath()).lastModified().toMSecsSinceEpoch())
+    };
+    const QStringList libraryPaths = QCoreApplication::libraryPaths();
+    for (const QString &libraryPath : libraryPaths)
+    {
+        const QFileInfoList plugins = QDir(QDir(libraryPath).filePath("imageformats")).entryInfoList(QDir::Files, QDir::Name);
+        for (const QFileInfo &plugin : plugins)
+            keyParts << QString("%1|%2|%3").arg(plugin.absoluteFilePath()).arg(plugin.size()).arg(plugin.lastModified().toMSecsSinceEpoch());
+    }
+    return QString::fromLatin1(QCryptographicHash::hash(keyParts.join('\n').toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
 void QVApplication::ensureFontLoaded(const QString &path)
 {
     static QSet<QString> loadedFontPaths;
@@ -6,6 +6,8 @@
 #include "shortcutmanager.h"
 #include "actionmanager.h"
 #include "updatechecker.h"
+#include "qvimageloader.h"
+#include "qvsingleinstance.h"
 #include "qvoptionsdialog.h"
 #include "qvaboutdialog.h"
 #include "qvwelcomedialog.h"
@@ -37,6 +39,12 @@ public:
         Cancel
     };
 
+    struct SupportedImageFormats
+    {
+        QList<QByteArray> formats;
+        QList<QByteArray> mimeTypes;
+    };
+
     explicit QVApplication(int &argc, char **argv);
     ~QVApplication() override;
 
@@ -52,6 +60,11 @@ public:
 
     static MainWindow *newWindow(const QJsonObject &windowSessionState = {});
 
+    void openForwardedFiles(const QStringList &files);
+
+    // Called once something has been painted, to start work that was held back during startup
+    void finishStartup();
+
     MainWindow *getMainWindow(bool shouldBeEmpty);
 
     void checkedUpdates();
@@ -76,7 +89,7 @@ public:
 
     void hideIncompatibleActions();
 
-    void settingsUpdated();
+    void settingsUpdated(const QSet<QString> &changedKeys);
 
     void defineFilterLists();
 
@@ -101,6 +114,8 @@ public:
 
     UpdateChecker &getUpdateChecker() { return updateChecker; }
 
+    const std::shared_ptr<QVImageLoader::SharedCache> &getImageCache() const { return imageCache; }
+
     bool getShowMainMenuIcons() const { return showMainMenuIcons; }
 
     bool getShowContextMenuIcons() const { return showContextMenuIcons; }
@@ -136,6 +151,10 @@ signals:
 protected:
     SessionSaveDecision getSessionSaveDecision() const;
 
+    static SupportedImageFormats loadSupportedImageFormats();
+
+    static QString getImageFormatCacheKey();
+
 protected slots:
     void onCommitDataRequest(QSessionManager &manager);
 
@@ -147,12 +166,14 @@ private:
 
     QSet<MainWindow*> activeWindows;
 
-    QMenu *dockMenu;
+    QMenu *dockMenu {nullptr};
 
-    QMenuBar *menuBar;
+    QMenuBar *menuBar {nullptr};
 
     QSet<QString> disabledFileExtensions;
 
+    std::optional<SupportedImageFormats> supportedImageFormats;
+
     QSet<QString> allFileExtensionSet;
     QSet<QString> fileExtensionSet;
     QSet<QString> mimeTypeNameSet;
@@ -174,8 +195,17 @@ private:
 
     UpdateChecker updateChecker;
 
+    // Decoded images shared by every window
+    std::shared_ptr<QVImageLoader::SharedCache> imageCache {std::make_shared<QVImageLoader::SharedCache>()};
+
+    QVSingleInstance singleInstance;
+
     bool isSessionStateSaveRequested {false};
     QList<ClosedWindowData> closedWindowData;
+
+    bool isStartupFinished {false};
+
+    static constexpr int deferredStartupFallbackMs {3000};
 };
 
 #endif // QVAPPLICATION_H
@@ -3,14 +3,23 @@
 #include "qvinfodialog.h"
 #include "qvmovie.h"
 #include "qvcocoafunctions.h"
+#include "qvtrace.h"
+#include <QBuffer>
 #include <QWheelEvent>
-#include <QGraphicsPixmapItem>
 #include <QGraphicsScene>
 #include <QSettings>
 #include <QMessageBox>
 #include <QtMath>
 #include <QGestureEvent>
 #include <QScrollBar>
+#include <QPainter>
+#include <QFontDatabase>
+
+#ifdef OPENGL_LOADED
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLWidget>
+#endif
 
 QVGraphicsView::QVGraphicsView(QWidget *parent) : QGraphicsView(parent)
 {
@@ -36,7 +45,10 @@ QVGraphicsView::QVGraphicsView(QWidget *parent) : QGraphicsView(parent)
             p.shouldCenter = constrainToCenterWhenSmaller;
         });
 
+    connect(&imageCore, &QVImageCore::animatedFrameAboutToChange, this, &QVGraphicsView::animatedFrameAboutToChange);
     connect(&imageCore, &QVImageCore::animatedFrameChanged, this, &QVGraphicsView::animatedFrameChanged);
+    connect(&imageCore, &QVImageCore::scaledPixmapReady, this, &QVGraphicsView::applyExpensiveScaling);
+    connect(&imageCore, &QVImageCore::mipmapReady, this, &QVGraphicsView::handleSmoothScalingChange);
     connect(&imageCore, &QVImageCore::fileChanging, this, &QVGraphicsView::beforeLoad);
     connect(&imageCore, &QVImageCore::fileChanged, this, &QVGraphicsView::postLoad);
     connect(&imageCore, &QVImageCore::sortParametersChanged, this, [this]{emit sortParametersChanged();});
@@ -55,12 +67,16 @@ QVGraphicsView::QVGraphicsView(QWidget *parent) : QGraphicsView(parent)
     hideCursorTimer->setInterval(1000);
     connect(hideCursorTimer, &QTimer::timeout, this, [this]{setCursorVisible(false);});
 
-    loadedPixmapItem = new QGraphicsPixmapItem();
+    performanceOverlayTimer = new QTimer(this);
+    performanceOverlayTimer->setInterval(500);
+    connect(performanceOverlayTimer, &QTimer::timeout, this, [this]{viewport()->update();});
+
+    loadedPixmapItem = new QVTiledPixmapItem();
     scene->addItem(loadedPixmapItem);
 
     // Connect to settings signal
-    connect(&qvApp->getSettingsManager(), &SettingsManager::settingsUpdated, this, [this]{settingsUpdated(false);});
-    settingsUpdated(true);
+    connect(&qvApp->getSettingsManager(), &SettingsManager::settingsUpdated, this, [this](const QSet<QString> &changedKeys){settingsUpdated(changedKeys);});
+    settingsUpdated(qvApp->getSettingsManager().getAllKeys(), true);
 }
 
 // Events
@@ -87,7 +103,60 @@ void QVGraphicsView::paintEvent(QPaintEvent *event)
     // doesn't detect when the DPI is changed on the current monitor, for example.
     handleDpiAdjustmentChange();
 
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
     QGraphicsView::paintEvent(event);
+
+    lastPaintMs = paintTimer.nsecsElapsed() / 1000000.0;
+    if (firstPaintTimer.isValid())
+    {
+        firstPaintMs = firstPaintTimer.nsecsElapsed() / 1000000.0;
+        firstPaintTimer.invalidate();
+        QVTrace::instant("QVGraphicsView::firstPaint", [&]{ return QJsonObject {{"ms", firstPaintMs}}; });
+        qvApp->finishStartup();
+    }
+}
+
+void QVGraphicsView::drawBackground(QPainter *painter, const QRectF &rect)
+{
+    if (!isViewportAccelerated())
+    {
+        QGraphicsView::drawBackground(painter, rect);
+        return;
+    }
+
+    // Unlike the raster viewport, an OpenGL viewport can't let the window's background show
+    // through, so paint it here instead
+    painter->save();
+    painter->resetTransform();
+    painter->translate(-viewport()->mapTo(getMainWindow(), QPoint()));
+    getMainWindow()->paintBackground(*painter);
+    painter->restore();
+}
+
+void QVGraphicsView::drawForeground(QPainter *painter, const QRectF &rect)
+{
+    QGraphicsView::drawForeground(painter, rect);
+
+    if (!performanceOverlayVisible)
+        return;
+
+    const QString text = getPerformanceOverlayLines().join('\n');
+    if (text.isEmpty())
+        return;
+
+    painter->save();
+    painter->resetTransform();
+    painter->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    const int margin = 8;
+    const int topOffset = getMainWindow() ? getMainWindow()->getTitlebarOverlap() : 0;
+    const QRect textRect = painter->fontMetrics().boundingRect(viewport()->rect(), Qt::AlignLeft | Qt::AlignTop, text);
+    const QRect backgroundRect = textRect.adjusted(0, 0, margin * 2, margin * 2).translated(margin, margin + topOffset);
+    painter->fillRect(backgroundRect, QColor(0, 0, 0, 160));
+    painter->setPen(Qt::white);
+    painter->drawText(backgroundRect.adjusted(margin, margin, -margin, -margin), Qt::AlignLeft | Qt::AlignTop, text);
+    painter->restore();
 }
 
 void QVGraphicsView::dropEvent(QDropEvent *event)
@@ -99,7 +168,7 @@ void QVGraphicsView::dropEvent(QDropEvent *event)
 void QVGraphicsView::dragEnterEvent(QDragEnterEvent *event)
 {
     QGraphicsView::dragEnterEvent(event);
-    if (event->mimeData()->hasUrls())
+    if (event->mimeData()->hasUrls() || event->mimeData()->hasImage())
     {
         event->acceptProposedAction();
     }
@@ -584,7 +653,16 @@ void QVGraphicsView::loadMimeData(const QMimeData *mimeData)
         return;
 
     if (!mimeData->hasUrls())
+    {
+        // Image data with no file behind it, like an image copied from a browser
+        const QByteArray imageData = getEncodedImageData(mimeData);
+        if (!imageData.isEmpty())
+        {
+            imageCore.loadData(imageData);
+            emit cancelSlideshow();
+        }
         return;
+    }
 
     const QList<QUrl> urlList = mimeData->urls();
 
@@ -602,6 +680,31 @@ void QVGraphicsView::loadMimeData(const QMimeData *mimeData)
     }
 }
 
+QByteArray QVGraphicsView::getEncodedImageData(const QMimeData *mimeData)
+{
+    // Prefer the original encoding, which keeps animations and metadata intact
+    const QSet<QString> &mimeTypeNameSet = qvApp->getMimeTypeNameSet();
+    for (const QString &format : mimeData->formats())
+    {
+        if (!mimeTypeNameSet.contains(format))
+            continue;
+
+        const QByteArray data = mimeData->data(format);
+        if (!data.isEmpty())
+            return data;
+    }
+
+    if (!mimeData->hasImage())
+        return {};
+
+    // Some sources only offer a bitmap
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    qvariant_cast<QImage>(mimeData->imageData()).save(&buffer, "png");
+    return data;
+}
+
 void QVGraphicsView::loadFile(const QString &fileName, const QString &baseDir)
 {
     imageCore.loadFile(fileName, false, baseDir);
@@ -611,7 +714,7 @@ void QVGraphicsView::reloadFile()
 {
     imageCore.markFolderInfoDirty();
 
-    if (getCurrentFileDetails().isPixmapLoaded)
+    if (getCurrentFileDetails().isPixmapLoaded && !getCurrentFileDetails().isInMemory)
         imageCore.loadFile(getCurrentFileDetails().fileInfo.absoluteFilePath(), true);
 }
 
@@ -624,6 +727,9 @@ void QVGraphicsView::beforeLoad()
 
 void QVGraphicsView::postLoad()
 {
+    QVTraceScope traceScope("QVGraphicsView::postLoad");
+    firstPaintTimer.start();
+
     scrollHelper->cancelAnimation();
 
     // Set the pixmap to the new image and reset the transform's scale to a known value
@@ -633,6 +739,10 @@ void QVGraphicsView::postLoad()
     if (lastImageContentRect.isValid())
         matchContentCenter(lastImageContentRect);
 
+    // An OpenGL viewport paints the window's background too, which shows any error message
+    if (isViewportAccelerated())
+        viewport()->update();
+
     const auto &fileDetails = getCurrentFileDetails();
     if (!fileDetails.fileInfo.filePath().isEmpty() && !fileDetails.errorData.has_value())
         qvApp->getActionManager().addFileToRecentsList(fileDetails.fileInfo);
@@ -648,6 +758,7 @@ void QVGraphicsView::postLoad()
     }
     loadIsFromSessionRestore = false;
 
+    requestMipmapIfUseful();
     expensiveScaleTimer->start();
 
     if (turboNavMode.has_value())
@@ -711,7 +822,7 @@ void QVGraphicsView::zoomAbsolute(const qreal absoluteLevel, const std::optional
     }
     else
     {
-        setTransformScale(absoluteLevel * appliedDpiAdjustment);
+        setTransformScale(absoluteLevel * appliedDpiAdjustment, appliedMipmapScale);
     }
     zoomLevel = absoluteLevel;
 
@@ -752,7 +863,7 @@ void QVGraphicsView::setCalculatedZoomMode(const std::optional<Qv::CalculatedZoo
         return;
     }
 
-    if (value == Qv::CalculatedZoomMode::OriginalSize && zoomLevel == 1 && !isNavigating && qvApp->getSettingsManager().getBoolean("originalsizeastoggle"))
+    if (value == Qv::CalculatedZoomMode::OriginalSize && zoomLevel == 1 && !isNavigating && qvApp->getSettingsManager().getSnapshot().originalSizeAsToggle)
     {
         setCalculatedZoomMode(defaultCalculatedZoomMode != Qv::CalculatedZoomMode::OriginalSize ? defaultCalculatedZoomMode : Qv::CalculatedZoomMode::ZoomToFit);
         return;
@@ -787,12 +898,24 @@ void QVGraphicsView::applyExpensiveScaling()
     if (!isExpensiveScalingRequested())
         return;
 
+    QVTraceScope traceScope("QVGraphicsView::applyExpensiveScaling");
+
     // Calculate scaled resolution
     const qreal dpiAdjustment = getDpiAdjustment();
     const QSizeF mappedSize = QSizeF(getCurrentFileDetails().loadedPixmapSize) * zoomLevel * dpiAdjustment * devicePixelRatioF();
 
-    // Set image to scaled version
-    loadedPixmapItem->setPixmap(imageCore.scaleExpensively(mappedSize));
+    // Set image to scaled version once it's ready. Until then, keep showing what we have, which will
+    // be transformed to the current zoom level; animation frames are shown unscaled though, because
+    // a previously scaled pixmap would be of an older frame.
+    const QPixmap scaledPixmap = imageCore.scaleExpensively(mappedSize);
+    traceScope.setArg("ready", !scaledPixmap.isNull());
+    if (scaledPixmap.isNull())
+    {
+        if (getCurrentFileDetails().isMovieLoaded)
+            removeExpensiveScaling();
+        return;
+    }
+    loadedPixmapItem->setPixmap(scaledPixmap);
 
     // Set appropriate scale factor
     const qreal newTransformScale = 1.0 / devicePixelRatioF();
@@ -803,25 +926,98 @@ void QVGraphicsView::applyExpensiveScaling()
 
 void QVGraphicsView::removeExpensiveScaling()
 {
-    // Return to original size
-    loadedPixmapItem->setPixmap(imageCore.getLoadedPixmap());
+    // Return to original size, or the nearest mipmap level if zoomed out far enough
+    const QPixmap pixmap = getMipmappedPixmap();
+    loadedPixmapItem->setPixmap(pixmap);
+
+    // Each level rounds its width and height separately, so scale them back up separately too
+    const QSizeF originalSize = getCurrentFileDetails().loadedPixmapSize;
+    const QSizeF mipmapScale = pixmap.isNull() ? QSizeF(1.0, 1.0) :
+        QSizeF(originalSize.width() / pixmap.width(), originalSize.height() / pixmap.height());
 
     // Set appropriate scale factor
     const qreal dpiAdjustment = getDpiAdjustment();
-    const qreal newTransformScale = zoomLevel * dpiAdjustment;
-    setTransformScale(newTransformScale);
+    setTransformScale(zoomLevel * dpiAdjustment, mipmapScale);
     appliedDpiAdjustment = dpiAdjustment;
+    appliedMipmapScale = mipmapScale;
     appliedExpensiveScaleZoomLevel = 0.0;
 }
 
-void QVGraphicsView::animatedFrameChanged(QRect rect)
+#ifdef OPENGL_LOADED
+static bool isOpenGLAvailable()
+{
+    // Probe once whether OpenGL is usable at all. Machines without a GPU usually still get a
+    // software implementation such as llvmpipe here, and if not, the raster viewport is kept.
+    static const bool isAvailable = []{
+        QOffscreenSurface surface;
+        surface.create();
+        QOpenGLContext context;
+        if (!context.create() || !context.makeCurrent(&surface))
+            return false;
+        context.doneCurrent();
+        return true;
+    }();
+    return isAvailable;
+}
+#endif
+
+bool QVGraphicsView::isViewportAccelerated() const
 {
-    Q_UNUSED(rect)
+#ifdef OPENGL_LOADED
+    return qobject_cast<QOpenGLWidget*>(viewport()) != nullptr;
+#else
+    return false;
+#endif
+}
 
+void QVGraphicsView::updateViewportWidget()
+{
+#ifdef OPENGL_LOADED
+    // Only depends on the setting, since switching means a new context and uploading everything
+    // again. Errors and empty windows are painted through drawBackground like any other backdrop.
+    const bool shouldAccelerate = hardwareAccelerationEnabled && isOpenGLAvailable();
+    if (shouldAccelerate == isViewportAccelerated())
+        return;
+
+    setViewport(shouldAccelerate ? new QOpenGLWidget() : new QWidget());
+    viewport()->setAutoFillBackground(false);
+    viewport()->setMouseTracking(true);
+    viewport()->setCursor(isCursorVisible ? Qt::ArrowCursor : Qt::BlankCursor);
+#endif
+}
+
+void QVGraphicsView::requestMipmapIfUseful()
+{
+    // Only worth building the smaller copies once zoomed out far enough to use one
+    if (isSmoothScalingRequested() && zoomLevel * getDpiAdjustment() * devicePixelRatioF() <= 0.5)
+        imageCore.requestMipmap();
+}
+
+QPixmap QVGraphicsView::getMipmappedPixmap() const
+{
+    if (!isSmoothScalingRequested())
+        return imageCore.getLoadedPixmap();
+
+    return imageCore.getMipmapLevel(zoomLevel * getDpiAdjustment() * devicePixelRatioF());
+}
+
+void QVGraphicsView::animatedFrameAboutToChange()
+{
+    if (loadedPixmapItem->pixmap().cacheKey() == imageCore.getLoadedPixmap().cacheKey())
+        loadedPixmapItem->releasePixmap();
+}
+
+void QVGraphicsView::animatedFrameChanged(QRect rect)
+{
     if (isExpensiveScalingRequested())
     {
         applyExpensiveScaling();
     }
+    else if (loadedPixmapItem->isPixmapReleased())
+    {
+        // The item still shows the previous frame everywhere else
+        loadedPixmapItem->updatePixmap(imageCore.getLoadedPixmap(), rect);
+    }
     else
     {
         loadedPixmapItem->setPixmap(imageCore.getLoadedPixmap());
@@ -1095,9 +1291,19 @@ QRect QVGraphicsView::getUsableViewportRect(const bool addOverscan) const
     return rect;
 }
 
-void QVGraphicsView::setTransformScale(const qreal value)
+void QVGraphicsView::setTransformScale(const qreal value, const QSizeF &pixmapScale)
+{
+    setTransformWithNormalization(getUnspecializedTransform().scale(value * pixmapScale.width(), value * pixmapScale.height()));
+}
+
+void QVGraphicsView::reapplyTransformScale()
 {
-    setTransformWithNormalization(getUnspecializedTransform().scale(value, value));
+    // A mipmap level can be scaled differently in each direction, which only comes out right if
+    // the scale is applied before any rotation
+    if (appliedExpensiveScaleZoomLevel != 0.0)
+        setTransformScale(zoomLevel / appliedExpensiveScaleZoomLevel / devicePixelRatioF());
+    else
+        setTransformScale(zoomLevel * appliedDpiAdjustment, appliedMipmapScale);
 }
 
 void QVGraphicsView::setTransformWithNormalization(const QTransform &matrix)
@@ -1153,9 +1359,11 @@ void QVGraphicsView::handleSmoothScalingChange()
 {
     loadedPixmapItem->setTransformationMode(isSmoothScalingRequested() ? Qt::SmoothTransformation : Qt::FastTransformation);
 
+    requestMipmapIfUseful();
+
     if (isExpensiveScalingRequested())
         expensiveScaleTimer->start();
-    else if (appliedExpensiveScaleZoomLevel != 0.0)
+    else if (appliedExpensiveScaleZoomLevel != 0.0 || getMipmappedPixmap().cacheKey() != loadedPixmapItem->pixmap().cacheKey())
         removeExpensiveScaling();
 }
 
@@ -1184,7 +1392,53 @@ MainWindow* QVGraphicsView::getMainWindow() const
     return qobject_cast<MainWindow*>(window());
 }
 
-void QVGraphicsView::settingsUpdated(const bool isInitialLoad)
+void QVGraphicsView::setPerformanceOverlayVisible(const bool value)
+{
+    if (performanceOverlayVisible == value)
+        return;
+
+    performanceOverlayVisible = value;
+    if (performanceOverlayVisible)
+        performanceOverlayTimer->start();
+    else
+        performanceOverlayTimer->stop();
+    viewport()->update();
+}
+
+QStringList QVGraphicsView::getPerformanceOverlayLines() const
+{
+    QStringList lines;
+
+    if (getCurrentFileDetails().isPixmapLoaded)
+    {
+        const QVImageCore::ImageTimings &timings = imageCore.getImageTimings();
+        lines << QString("Stat %1 ms, decode %2 ms").arg(timings.statMs, 0, 'f', 1).arg(timings.decodeMs, 0, 'f', 1);
+        lines << QString("Color %1 ms, upload %2 ms").arg(timings.colorConversionMs, 0, 'f', 1).arg(timings.pixmapUploadMs, 0, 'f', 1);
+        lines << QString("First paint %1 ms, paint %2 ms").arg(firstPaintMs, 0, 'f', 1).arg(lastPaintMs, 0, 'f', 1);
+        lines << QString("Scale %1 ms").arg(timings.expensiveScaleMs, 0, 'f', 1);
+    }
+
+    const QVImageLoader::Stats loaderStats = imageCore.getLoaderStats();
+    const qint64 bytesPerMegabyte = 1024 * 1024;
+    lines << QString("Loader %1 cached (%2 MB), %3 queued, %4 loading").arg(loaderStats.cachedCount).arg(loaderStats.cachedBytes / bytesPerMegabyte).arg(loaderStats.queuedCount).arg(loaderStats.loadingCount);
+    lines << QString("Preload hits %1 ready, %2 in progress, of %3").arg(loaderStats.cachedRequestCount).arg(loaderStats.loadingRequestCount).arg(loaderStats.requestCount);
+    lines << QString("Shared with other windows %1").arg(loaderStats.sharedJobCount);
+    lines << QString("Scaled cache %1 MB").arg(imageCore.getScaledCacheBytes() / bytesPerMegabyte);
+
+    if (getCurrentFileDetails().isMovieLoaded)
+    {
+        const QVMovie &movie = getLoadedMovie();
+        const QVMovie::FrameTimingStats stats = movie.frameTimingStats();
+        lines << QString("Frame %1/%2").arg(movie.currentFrameNumber() + 1).arg(movie.frameCount());
+        lines << QString("Decode %1 ms avg, %2 ms max").arg(stats.averageDecodeMs, 0, 'f', 1).arg(stats.maxDecodeMs, 0, 'f', 1);
+        lines << QString("Lateness %1 ms avg, %2 late, %3 dropped").arg(stats.averageLatenessMs, 0, 'f', 1).arg(stats.lateFrameCount).arg(stats.droppedFrameCount);
+        lines << QString("FPS %1 of %2").arg(stats.effectiveFps, 0, 'f', 1).arg(stats.intendedFps, 0, 'f', 1);
+    }
+
+    return lines;
+}
+
+void QVGraphicsView::settingsUpdated(const QSet<QString> &changedKeys, const bool isInitialLoad)
 {
     auto &settingsManager = qvApp->getSettingsManager();
 
@@ -1256,6 +1510,12 @@ void QVGraphicsView::settingsUpdated(const bool isInitialLoad)
     isCursorAutoHideFullscreenEnabled = settingsManager.getBoolean("cursorautohidefullscreenenabled");
     hideCursorTimer->setInterval(settingsManager.getDouble("cursorautohidefullscreendelay") * 1000.0);
 
+    //hardware acceleration
+    hardwareAccelerationEnabled = settingsManager.getBoolean("hardwareacceleration");
+    updateViewportWidget();
+    if (isViewportAccelerated())
+        viewport()->update();
+
     // End of settings variables
 
     if (isInitialLoad)
@@ -1263,13 +1523,22 @@ void QVGraphicsView::settingsUpdated(const bool isInitialLoad)
         setCalculatedZoomMode(defaultCalculatedZoomMode);
     }
 
-    handleSmoothScalingChange();
+    if (changedKeys.contains("smoothscalingmode") || changedKeys.contains("scalingtwoenabled") ||
+        changedKeys.contains("smoothscalinglimitenabled") || changedKeys.contains("smoothscalinglimitpercent"))
+    {
+        handleSmoothScalingChange();
+    }
 
     handleDpiAdjustmentChange();
 
-    fitOrConstrainImage();
+    if (changedKeys.contains("fitzoomlimitenabled") || changedKeys.contains("fitzoomlimitpercent") || changedKeys.contains("fitoverscan") ||
+        changedKeys.contains("constrainimageposition") || changedKeys.contains("constraincentersmallimage"))
+    {
+        fitOrConstrainImage();
+    }
 
-    setCursorVisible(true);
+    if (changedKeys.contains("cursorautohidefullscreenenabled") || changedKeys.contains("cursorautohidefullscreendelay"))
+        setCursorVisible(true);
 }
 
 void QVGraphicsView::closeImage(const bool stayInDir)
@@ -1303,6 +1572,7 @@ void QVGraphicsView::rotateImage(const int relativeAngle)
     const QTransform t = transform();
     const bool isMirroredOrFlipped = t.isRotating() ? ((t.m12() < 0) == (t.m21() < 0)) : ((t.m11() < 0) != (t.m22() < 0));
     setTransformWithNormalization(transform().rotate(relativeAngle * (isMirroredOrFlipped ? -1 : 1)));
+    reapplyTransformScale();
     matchContentCenter(oldRect);
 }
 
@@ -1311,6 +1581,7 @@ void QVGraphicsView::mirrorImage()
     const QRect oldRect = getContentRect();
     const int rotateCorrection = transform().isRotating() ? -1 : 1;
     setTransformWithNormalization(transform().scale(-1 * rotateCorrection, 1 * rotateCorrection));
+    reapplyTransformScale();
     matchContentCenter(oldRect);
 }
 
@@ -1319,14 +1590,14 @@ void QVGraphicsView::flipImage()
     const QRect oldRect = getContentRect();
     const int rotateCorrection = transform().isRotating() ? -1 : 1;
     setTransformWithNormalization(transform().scale(1 * rotateCorrection, -1 * rotateCorrection));
+    reapplyTransformScale();
     matchContentCenter(oldRect);
 }
 
 void QVGraphicsView::resetTransformation()
 {
     const QRect oldRect = getContentRect();
-    const QTransform t = transform();
-    const qreal scale = qFabs(t.isRotating() ? t.m21() : t.m11());
-    setTransformWithNormalization(QTransform::fromScale(scale, scale));
+    setTransform(QTransform());
+    reapplyTransformScale();
     matchContentCenter(oldRect);
 }
@@ -6,6 +6,7 @@
 #include "axislocker.h"
 #include "logicalpixelfitter.h"
 #include "scrollhelper.h"
+#include "qvtiledpixmapitem.h"
 #include <optional>
 #include <QGraphicsView>
 #include <QImageReader>
@@ -71,7 +72,7 @@ public:
 
     void goToFile(const Qv::GoToFileMode mode, const int index = 0);
 
-    void settingsUpdated(const bool isInitialLoad);
+    void settingsUpdated(const QSet<QString> &changedKeys, const bool isInitialLoad = false);
 
     void closeImage(const bool stayInDir = false);
     void jumpToNextFrame();
@@ -96,6 +97,9 @@ public:
 
     int getFitOverscan() const { return fitOverscan; }
 
+    bool getPerformanceOverlayVisible() const { return performanceOverlayVisible; }
+    void setPerformanceOverlayVisible(const bool value);
+
 signals:
     void cancelSlideshow();
 
@@ -114,6 +118,10 @@ protected:
 
     void paintEvent(QPaintEvent *event) override;
 
+    void drawBackground(QPainter *painter, const QRectF &rect) override;
+
+    void drawForeground(QPainter *painter, const QRectF &rect) override;
+
     void dropEvent(QDropEvent *event) override;
 
     void dragEnterEvent(QDragEnterEvent *event) override;
@@ -156,15 +164,27 @@ protected:
 
     bool isExpensiveScalingRequested() const;
 
+    void requestMipmapIfUseful();
+
+    QPixmap getMipmappedPixmap() const;
+
+    bool isViewportAccelerated() const;
+
+    void updateViewportWidget();
+
     void matchContentCenter(const QRect target);
 
     std::optional<Qv::GoToFileMode> getNavigationRegion(const QPoint mousePos) const;
 
+    static QByteArray getEncodedImageData(const QMimeData *mimeData);
+
     QRect getContentRect() const;
 
     QRect getUsableViewportRect(const bool addOverscan = false) const;
 
-    void setTransformScale(const qreal absoluteScale);
+    void setTransformScale(const qreal absoluteScale, const QSizeF &pixmapScale = QSizeF(1.0, 1.0));
+
+    void reapplyTransformScale();
 
     void setTransformWithNormalization(const QTransform &matrix);
 
@@ -184,7 +204,11 @@ protected:
 
     MainWindow* getMainWindow() const;
 
+    QStringList getPerformanceOverlayLines() const;
+
 private slots:
+    void animatedFrameAboutToChange();
+
     void animatedFrameChanged(QRect rect);
 
     void beforeLoad();
@@ -192,7 +216,7 @@ private slots:
     void postLoad();
 
 private:
-    QGraphicsPixmapItem *loadedPixmapItem;
+    QVTiledPixmapItem *loadedPixmapItem;
 
     Qv::SmoothScalingMode smoothScalingMode {Qv::SmoothScalingMode::Disabled};
     std::optional<qreal> smoothScalingLimit;
@@ -230,17 +254,24 @@ private:
     qreal zoomLevel {1.0};
     qreal appliedDpiAdjustment {1.0};
     qreal appliedExpensiveScaleZoomLevel {0.0};
+    QSizeF appliedMipmapScale {1.0, 1.0};
     std::optional<QPoint> lastZoomEventPos;
     QPointF lastZoomRoundingError;
     bool isCursorAutoHideFullscreenEnabled {true};
     bool isCursorVisible {true};
     QRect lastImageContentRect;
+    bool performanceOverlayVisible {false};
+    QElapsedTimer firstPaintTimer;
+    double firstPaintMs {0.0};
+    double lastPaintMs {0.0};
+    bool hardwareAccelerationEnabled {false};
 
     QVImageCore imageCore {this};
 
     QTimer *expensiveScaleTimer;
     QTimer *constrainBoundsTimer;
     QTimer *hideCursorTimer;
+    QTimer *performanceOverlayTimer;
 
     ScrollHelper *scrollHelper;
     AxisLocker scrollAxisLocker;
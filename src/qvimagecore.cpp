@@ -1,4 +1,6 @@
 #include "qvimagecore.h"
+#include "qvimagescaler.h"
+#include "qvtrace.h"
 #include "qvapplication.h"
 #include "qvwin32functions.h"
 #include "qvcocoafunctions.h"
@@ -12,15 +14,34 @@
 #include <QIcon>
 #include <QGuiApplication>
 #include <QScreen>
+#include <QPainter>
+#include <QThreadPool>
+#include <QElapsedTimer>
 
 QVImageCore::QVImageCore(QObject *parent) : QObject(parent)
 {
     QImageReader::setAllocationLimit(8192); // 8 GiB
 
     connect(&loadedMovie, &QVMovie::updated, this, [this](QRect rect){
-        QImage movieImage = loadedMovie.currentImage();
-        handleColorSpaceConversion(movieImage, currentFileDetails.targetColorSpace);
-        loadedPixmap = QPixmap::fromImage(std::move(movieImage));
+        const QPixmap moviePixmap = loadedMovie.currentPixmap();
+        if (rect != moviePixmap.rect() && loadedPixmap.size() == moviePixmap.size())
+        {
+            // Only convert the part of the frame that changed and patch it in place, once the
+            // view has let go of the pixmap so painting doesn't copy all of it
+            QImage changedImage = moviePixmap.copy(rect).toImage();
+            handleColorSpaceConversion(changedImage, currentFileDetails.targetColorSpace);
+            emit animatedFrameAboutToChange();
+            QPainter painter(&loadedPixmap);
+            painter.setCompositionMode(QPainter::CompositionMode_Source);
+            painter.drawImage(rect.topLeft(), changedImage);
+        }
+        else
+        {
+            QImage movieImage = moviePixmap.toImage();
+            handleColorSpaceConversion(movieImage, currentFileDetails.targetColorSpace);
+            loadedPixmap = QPixmap::fromImage(std::move(movieImage));
+            rect = loadedPixmap.rect();
+        }
         emit animatedFrameChanged(rect);
     });
 
@@ -36,8 +57,7 @@ QVImageCore::QVImageCore(QObject *parent) : QObject(parent)
             loadPixmap(readData);
 
             // A fileChanged handler may have synchronously requested another image.
-            if (loadInProgress ||
-                currentFileDetails.fileInfo.absoluteFilePath() != readData.absoluteFilePath)
+            if (loadInProgress || loadedSource.key != readData.source.key)
             {
                 return;
             }
@@ -59,37 +79,19 @@ QVImageCore::QVImageCore(QObject *parent) : QObject(parent)
         emit sortParametersChanged();
     });
 
-    for (auto const &screen : QGuiApplication::screens())
-    {
-        const QSize adjustedSize = screen->size() * screen->devicePixelRatio();
-        const int largerDimension = qMax(adjustedSize.width(), adjustedSize.height());
-        if (largerDimension > largestDimension)
-            largestDimension = largerDimension;
-    }
+    largestDimension = getLargestScreenDimension();
     imageLoader.setLargestDimension(largestDimension);
+    imageLoader.setSharedCache(qvApp->getImageCache());
 
     // Connect to settings signal
     connect(&qvApp->getSettingsManager(), &SettingsManager::settingsUpdated, this, &QVImageCore::settingsUpdated);
     connect(qvApp, &QVApplication::folderListingsInvalidated, this, &QVImageCore::markFolderInfoDirty);
-    settingsUpdated();
+    settingsUpdated(qvApp->getSettingsManager().getAllKeys());
 }
 
 void QVImageCore::loadFile(const QString &fileName, const bool isReloading, const QString &baseDir, const bool debouncePreloading)
 {
-    QString adjustedFileName = fileName;
-
-    //sanitize file name if necessary
-    QUrl fileUrl = QUrl(adjustedFileName);
-    if (fileUrl.isLocalFile())
-        adjustedFileName = fileUrl.toLocalFile();
-
-#ifdef WIN32_LOADED
-    QString longFileName = QVWin32Functions::getLongPath(QDir::toNativeSeparators(QFileInfo(adjustedFileName).absoluteFilePath()));
-    if (!longFileName.isEmpty())
-        adjustedFileName = longFileName;
-#endif
-
-    QFileInfo fileInfo(adjustedFileName);
+    QFileInfo fileInfo(getAdjustedFileName(fileName));
     QString absolutePath = fileInfo.absoluteFilePath();
 
     if (fileInfo.isDir())
@@ -107,6 +109,16 @@ void QVImageCore::loadFile(const QString &fileName, const bool isReloading, cons
         updateFolderInfo(baseDir);
     }
 
+    requestSource(QVImageLoader::Source::fromFile(absolutePath), isReloading, debouncePreloading);
+}
+
+void QVImageCore::loadData(const QByteArray &data)
+{
+    requestSource(QVImageLoader::Source::fromData(data), false, false);
+}
+
+void QVImageCore::requestSource(const QVImageLoader::Source &source, const bool isReloading, const bool debouncePreloading)
+{
     // Pause playing movie because it feels better that way
     setPaused(true);
 
@@ -114,13 +126,17 @@ void QVImageCore::loadFile(const QString &fileName, const bool isReloading, cons
     preloadDebounceTimer.stop();
     loadInProgress = true;
     pendingLoadDebouncesPreloading = debouncePreloading;
-    pendingLoadRequestId = imageLoader.requestImage(absolutePath, isReloading);
+    pendingLoadRequestId = imageLoader.requestImage(source, isReloading);
 }
 
 void QVImageCore::loadPixmap(const ReadData &readData)
 {
+    QVTraceScope traceScope("QVImageCore::loadPixmap", [&]{ return QJsonObject {{"path", readData.source.key}}; });
+
     emit fileChanging();
 
+    loadedSource = readData.source;
+
     if (readData.errorData.has_value())
     {
         FileDetails emptyDetails;
@@ -134,13 +150,24 @@ void QVImageCore::loadPixmap(const ReadData &readData)
         currentFileDetails.errorData = {};
     }
 
-    // Do this first so we can keep folder info even when loading errored files
-    currentFileDetails.fileInfo = QFileInfo(readData.absoluteFilePath);
-    currentFileDetails.updateLoadedIndexInFolder();
-    if (currentFileDetails.loadedIndexInFolder == -1)
+    currentFileDetails.isInMemory = readData.source.isInMemory();
+    if (currentFileDetails.isInMemory)
+    {
+        // There's no folder to navigate through
+        currentFileDetails.fileInfo = QFileInfo();
+        currentFileDetails.folderFileInfoList = {};
+        currentFileDetails.loadedIndexInFolder = -1;
+    }
+    else
     {
-        // If the current list of files doesn't contain this one, assume we're switching folders now
-        updateFolderInfo(currentFileDetails.fileInfo.path());
+        // Do this first so we can keep folder info even when loading errored files
+        currentFileDetails.fileInfo = QFileInfo(readData.absoluteFilePath);
+        currentFileDetails.updateLoadedIndexInFolder();
+        if (currentFileDetails.loadedIndexInFolder == -1)
+        {
+            // If the current list of files doesn't contain this one, assume we're switching folders now
+            updateFolderInfo(currentFileDetails.fileInfo.path());
+        }
     }
 
     if (currentFileDetails.errorData.has_value())
@@ -149,10 +176,24 @@ void QVImageCore::loadPixmap(const ReadData &readData)
         return;
     }
 
+    imageTimings = {};
+    imageTimings.statMs = readData.timings.statMs;
+    imageTimings.decodeMs = readData.timings.decodeMs;
+
+    QElapsedTimer stepTimer;
+    stepTimer.start();
+    double traceStartTime = QVTrace::now();
     QImage readImage = readData.image;
     const QColorSpace targetColorSpace = getTargetColorSpace();
     handleColorSpaceConversion(readImage, targetColorSpace);
+    imageTimings.colorConversionMs = stepTimer.nsecsElapsed() / 1000000.0;
+    QVTrace::complete("QVImageCore::handleColorSpaceConversion", traceStartTime);
+
+    stepTimer.start();
+    traceStartTime = QVTrace::now();
     loadedPixmap = QPixmap::fromImage(std::move(readImage));
+    imageTimings.pixmapUploadMs = stepTimer.nsecsElapsed() / 1000000.0;
+    QVTrace::complete("QPixmap::fromImage", traceStartTime);
 
     // Set file details
     currentFileDetails.isPixmapLoaded = true;
@@ -160,17 +201,68 @@ void QVImageCore::loadPixmap(const ReadData &readData)
     currentFileDetails.loadedPixmapSize = loadedPixmap.size();
     currentFileDetails.targetColorSpace = targetColorSpace;
 
-    // Animation detection
+    // Animation detection, picking up the frames the loader prepared, and its reader if that hasn't been claimed yet
     loadedMovie.stop();
-    loadedMovie.setFormat("");
-    loadedMovie.setCacheMode(QVMovie::CacheAll);
-    loadedMovie.setFileName(currentFileDetails.fileInfo.absoluteFilePath());
-
-    // APNG workaround
-    if (loadedMovie.format() == "png")
+    clearScaledFrameCache();
+    clearMipmap();
+    const std::shared_ptr<QVImageLoader::PreparedAnimation> preparedAnimation = readData.preparedAnimation;
+    std::unique_ptr<QImageReader> preparedReader = preparedAnimation ? std::move(preparedAnimation->reader) : nullptr;
+
+    // Caching every frame makes looping and frame stepping free, but isn't viable for long or
+    // large animations, so those decode on demand and only keep the most recent run of frames
+    const auto chooseCacheMode = [this](const int frameCount) {
+        const qint64 frameBytes = qint64(loadedPixmap.width()) * loadedPixmap.height() * 4;
+        const bool cacheAllFrames = frameBytes * frameCount <= maxAnimationCacheBytes;
+        loadedMovie.setCacheMode(cacheAllFrames ? QVMovie::CacheAll : QVMovie::CacheNone);
+    };
+
+    if (preparedReader)
     {
-        loadedMovie.setFormat("apng");
-        loadedMovie.setFileName(currentFileDetails.fileInfo.absoluteFilePath());
+        chooseCacheMode(preparedAnimation->frameCount);
+        loadedMovie.setPreparedReader(std::move(preparedReader), preparedAnimation->frames, preparedAnimation->frameDelays);
+        loadedMovie.setFrameUpdateRects(preparedAnimation->frameUpdateRects);
+    }
+    else
+    {
+        const auto setMovieSource = [this]() {
+            if (loadedSource.isInMemory())
+            {
+                loadedMovieBuffer.seek(0);
+                loadedMovie.setDevice(&loadedMovieBuffer);
+            }
+            else
+            {
+                loadedMovie.setFileName(currentFileDetails.fileInfo.absoluteFilePath());
+            }
+        };
+
+        if (loadedSource.isInMemory())
+        {
+            loadedMovieBuffer.close();
+            loadedMovieBuffer.setData(loadedSource.data);
+            loadedMovieBuffer.open(QIODevice::ReadOnly);
+        }
+
+        loadedMovie.setFormat("");
+        // Oriented the same way as the frames the loader decoded
+        loadedMovie.setAutoTransform(true);
+        setMovieSource();
+
+        // APNG workaround
+        if (loadedMovie.format() == "png")
+        {
+            loadedMovie.setFormat("apng");
+            setMovieSource();
+        }
+
+        chooseCacheMode(loadedMovie.frameCount());
+
+        // Preloaded animations come with their first frames, just not the reader
+        if (preparedAnimation)
+        {
+            loadedMovie.setDecodedFrames(preparedAnimation->frames, preparedAnimation->frameDelays);
+            loadedMovie.setFrameUpdateRects(preparedAnimation->frameUpdateRects);
+        }
     }
 
     if (!readData.isMultiFrameImage && loadedMovie.isValid() && loadedMovie.frameCount() != 1)
@@ -185,6 +277,46 @@ void QVImageCore::loadPixmap(const ReadData &readData)
     emit fileChanged();
 }
 
+void QVImageCore::prefetchFile(const QString &fileName)
+{
+    const QFileInfo fileInfo(getAdjustedFileName(fileName));
+    if (!fileInfo.isFile())
+        return;
+
+    QVImageLoader::prefetchImage(fileInfo.absoluteFilePath(), getLargestScreenDimension());
+}
+
+QString QVImageCore::getAdjustedFileName(const QString &fileName)
+{
+    QString adjustedFileName = fileName;
+
+    //sanitize file name if necessary
+    QUrl fileUrl = QUrl(adjustedFileName);
+    if (fileUrl.isLocalFile())
+        adjustedFileName = fileUrl.toLocalFile();
+
+#ifdef WIN32_LOADED
+    QString longFileName = QVWin32Functions::getLongPath(QDir::toNativeSeparators(QFileInfo(adjustedFileName).absoluteFilePath()));
+    if (!longFileName.isEmpty())
+        adjustedFileName = longFileName;
+#endif
+
+    return adjustedFileName;
+}
+
+int QVImageCore::getLargestScreenDimension()
+{
+    int dimension = 1920;
+    for (auto const &screen : QGuiApplication::screens())
+    {
+        const QSize adjustedSize = screen->size() * screen->devicePixelRatio();
+        const int largerDimension = qMax(adjustedSize.width(), adjustedSize.height());
+        if (largerDimension > dimension)
+            dimension = largerDimension;
+    }
+    return dimension;
+}
+
 void QVImageCore::closeImage(const bool stayInDir)
 {
     preloadDebounceTimer.stop();
@@ -195,6 +327,7 @@ void QVImageCore::closeImage(const bool stayInDir)
     fileOrLoadPending = false;
 
     emit fileChanging();
+    loadedSource = {};
     FileDetails emptyDetails;
     if (stayInDir)
     {
@@ -210,6 +343,8 @@ void QVImageCore::loadEmptyPixmap()
     loadedPixmap = QPixmap();
     loadedMovie.stop();
     loadedMovie.setFileName("");
+    clearScaledFrameCache();
+    clearMipmap();
 
     emit fileChanged();
 }
@@ -481,27 +616,229 @@ QPixmap QVImageCore::scaleExpensively(const QSizeF desiredSize)
     size.rwidth() = qMax(size.width(), 1);
     size.rheight() = qMax(size.height(), 1);
 
-    return loadedPixmap.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    // Scaling on the UI thread would stall zooming and playback, so do it in the background and
+    // return a null pixmap for now; scaledPixmapReady is emitted once the result is available
+    if (!currentFileDetails.isMovieLoaded)
+    {
+        currentScaledRenditionKey = getScaledRenditionKey(size);
+        if (const QPixmap *rendition = scaledRenditionCache.object(currentScaledRenditionKey))
+            return *rendition;
+
+        if (!pendingScaledRenditions.contains(currentScaledRenditionKey))
+        {
+            const QString key = currentScaledRenditionKey;
+            pendingScaledRenditions.insert(key);
+            const QImage image = getMipmapLevel(qreal(size.width()) / loadedPixmap.width()).toImage();
+            startExpensiveScaling(image, size, [this, key](QImage scaledImage, const double elapsedMs) {
+                scaledRenditionFinished(key, std::move(scaledImage), elapsedMs);
+            });
+        }
+        return QPixmap();
+    }
+
+    if (size != scaledFrameCacheSize)
+    {
+        clearScaledFrameCache();
+        scaledFrameCacheSize = size;
+    }
+
+    const int frameNumber = getCurrentScaledFrameNumber();
+    if (const auto it = scaledFrameCache.constFind(frameNumber); it != scaledFrameCache.constEnd())
+        return it.value();
+
+    if (!pendingScaledFrames.contains(frameNumber))
+    {
+        pendingScaledFrames.insert(frameNumber);
+        const quint64 generation = scaledFrameGeneration;
+        startExpensiveScaling(loadedPixmap.toImage(), size, [this, frameNumber, generation](QImage scaledImage, const double elapsedMs) {
+            scaledFrameFinished(frameNumber, generation, std::move(scaledImage), elapsedMs);
+        });
+    }
+
+    return QPixmap();
+}
+
+QString QVImageCore::getScaledRenditionKey(const QSize &size) const
+{
+    const QFileInfo &fileInfo = currentFileDetails.fileInfo;
+    return QString("%1|%2|%3|%4x%5|%6|%7x%8").arg(
+        loadedSource.key,
+        QString::number(fileInfo.size()),
+        QString::number(fileInfo.lastModified().toMSecsSinceEpoch()),
+        QString::number(currentFileDetails.loadedPixmapSize.width()),
+        QString::number(currentFileDetails.loadedPixmapSize.height()),
+        currentFileDetails.targetColorSpace.description(),
+        QString::number(size.width()),
+        QString::number(size.height()));
+}
+
+void QVImageCore::startExpensiveScaling(const QImage &image, const QSize &size, std::function<void(QImage, double)> onFinished)
+{
+    const std::weak_ptr<int> weakLifetime = lifetimeToken;
+    QThreadPool::globalInstance()->start(
+        [weakLifetime, image, size, onFinished = std::move(onFinished)]() {
+            QVTraceScope traceScope("QVImageScaler::scaled", [&]{ return QJsonObject {{"width", size.width()}, {"height", size.height()}}; });
+            QElapsedTimer scaleTimer;
+            scaleTimer.start();
+            QImage scaledImage = QVImageScaler::scaled(image, size);
+            const double elapsedMs = scaleTimer.nsecsElapsed() / 1000000.0;
+            QMetaObject::invokeMethod(
+                QCoreApplication::instance(),
+                [weakLifetime, onFinished, elapsedMs, scaledImage = std::move(scaledImage)]() mutable {
+                    if (!weakLifetime.lock())
+                        return;
+                    onFinished(std::move(scaledImage), elapsedMs);
+                },
+                Qt::QueuedConnection
+            );
+        }
+    );
 }
 
-void QVImageCore::settingsUpdated()
+int QVImageCore::getCurrentScaledFrameNumber() const
+{
+    return currentFileDetails.isMovieLoaded ? loadedMovie.currentFrameNumber() : 0;
+}
+
+void QVImageCore::scaledFrameFinished(const int frameNumber, const quint64 generation, QImage scaledImage, const double elapsedMs)
+{
+    // Results for a previous file or size are stale
+    if (generation != scaledFrameGeneration)
+        return;
+
+    imageTimings.expensiveScaleMs = elapsedMs;
+
+    pendingScaledFrames.remove(frameNumber);
+
+    const qint64 frameBytes = scaledImage.sizeInBytes();
+    if (scaledFrameCacheBytes + frameBytes > maxScaledFrameCacheBytes)
+    {
+        scaledFrameCache.clear();
+        scaledFrameCacheBytes = 0;
+    }
+    scaledFrameCache.insert(frameNumber, QPixmap::fromImage(std::move(scaledImage)));
+    scaledFrameCacheBytes += frameBytes;
+
+    if (currentFileDetails.isPixmapLoaded && getCurrentScaledFrameNumber() == frameNumber)
+        emit scaledPixmapReady();
+}
+
+void QVImageCore::scaledRenditionFinished(const QString &key, QImage scaledImage, const double elapsedMs)
+{
+    pendingScaledRenditions.remove(key);
+
+    if (key == currentScaledRenditionKey)
+        imageTimings.expensiveScaleMs = elapsedMs;
+
+    // Results are kept even if the user has moved on, since they may come back to this image or size
+    const qsizetype cost = qMax<qsizetype>(scaledImage.sizeInBytes() / 1024, 1);
+    scaledRenditionCache.insert(key, new QPixmap(QPixmap::fromImage(std::move(scaledImage))), cost);
+
+    if (currentFileDetails.isPixmapLoaded && !currentFileDetails.isMovieLoaded && key == currentScaledRenditionKey)
+        emit scaledPixmapReady();
+}
+
+void QVImageCore::clearScaledFrameCache()
+{
+    scaledFrameCache.clear();
+    pendingScaledFrames.clear();
+    scaledFrameCacheSize = QSize();
+    scaledFrameCacheBytes = 0;
+    scaledFrameGeneration++;
+}
+
+void QVImageCore::requestMipmap()
+{
+    // Animation frames change too often for this to pay off
+    if (!currentFileDetails.isPixmapLoaded || currentFileDetails.isMovieLoaded || mipmapRequested)
+        return;
+
+    mipmapRequested = true;
+
+    QVImageCore *core = this;
+    const std::weak_ptr<int> weakLifetime = lifetimeToken;
+    const QImage image = loadedPixmap.toImage();
+    const quint64 generation = mipmapGeneration;
+    QThreadPool::globalInstance()->start(
+        [core, weakLifetime, image, generation]() {
+            QList<QImage> levels;
+            QImage level = image;
+            while (qMax(level.width(), level.height()) / 2 >= minimumMipmapDimension)
+            {
+                level = QVImageScaler::scaled(level, QSize(qMax((level.width() + 1) / 2, 1), qMax((level.height() + 1) / 2, 1)));
+                levels.append(level);
+            }
+            QMetaObject::invokeMethod(
+                QCoreApplication::instance(),
+                [core, weakLifetime, generation, levels]() {
+                    if (!weakLifetime.lock())
+                        return;
+                    core->mipmapFinished(generation, levels);
+                },
+                Qt::QueuedConnection
+            );
+        }
+    );
+}
+
+QPixmap QVImageCore::getMipmapLevel(const qreal scale) const
+{
+    if (currentFileDetails.isMovieLoaded || scale > 0.5)
+        return loadedPixmap;
+
+    // Use the smallest level that's still at least as large as what will be displayed, so that it
+    // only ever gets scaled down from there
+    QPixmap level = loadedPixmap;
+    qreal levelScale = 1.0;
+    for (const QPixmap &candidate : std::as_const(mipmapLevels))
+    {
+        levelScale /= 2;
+        if (levelScale < scale)
+            break;
+        level = candidate;
+    }
+    return level;
+}
+
+void QVImageCore::mipmapFinished(const quint64 generation, const QList<QImage> &levels)
+{
+    if (generation != mipmapGeneration || levels.isEmpty())
+        return;
+
+    for (const QImage &level : levels)
+        mipmapLevels.append(QPixmap::fromImage(level));
+
+    emit mipmapReady();
+}
+
+void QVImageCore::clearMipmap()
+{
+    mipmapLevels.clear();
+    mipmapRequested = false;
+    mipmapGeneration++;
+}
+
+void QVImageCore::settingsUpdated(const QSet<QString> &changedKeys)
 {
     auto &settingsManager = qvApp->getSettingsManager();
 
     //preloading mode
     preloadingMode = settingsManager.getEnum<Qv::PreloadMode>("preloadingmode");
 
-    //update folder info to reflect new settings (e.g. sort order)
+    //sort changes rescan through sortParametersChanged, so only rescan here if the set of listed files could differ
     fileEnumerator.loadSettings(false);
-    updateFolderInfo();
+    const bool isFolderListingChanged = changedKeys.contains("allowmimecontentdetection") ||
+        changedKeys.contains("skiphidden") || changedKeys.contains("disabledfileextensions");
+    if (isFolderListingChanged)
+        updateFolderInfo();
 
     //color space conversion
     Qv::ColorSpaceConversion oldColorSpaceConversion = colorSpaceConversion;
     colorSpaceConversion = settingsManager.getEnum<Qv::ColorSpaceConversion>("colorspaceconversion");
 
     if (colorSpaceConversion != oldColorSpaceConversion && currentFileDetails.isPixmapLoaded && !loadInProgress)
-        loadFile(currentFileDetails.fileInfo.absoluteFilePath());
-    else
+        requestSource(loadedSource, false, false);
+    else if (isFolderListingChanged || changedKeys.contains("preloadingmode") || changedKeys.contains("loopfoldersenabled"))
         refreshDesiredImages(!preloadDebounceTimer.isActive());
 }
 
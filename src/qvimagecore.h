@@ -5,8 +5,14 @@
 #include "qvfileenumerator.h"
 #include "qvimageloader.h"
 #include "qvmovie.h"
+#include <functional>
+#include <memory>
 #include <optional>
 #include <QObject>
+#include <QBuffer>
+#include <QCache>
+#include <QHash>
+#include <QSet>
 #include <QPixmap>
 #include <QFileInfo>
 #include <QTimer>
@@ -27,6 +33,8 @@ public:
         int loadedIndexInFolder = -1;
         bool isPixmapLoaded = false;
         bool isMovieLoaded = false;
+        // Pasted or dropped image data that has no file behind it
+        bool isInMemory = false;
         QSize baseImageSize;
         QSize loadedPixmapSize;
         QColorSpace targetColorSpace;
@@ -40,9 +48,22 @@ public:
         bool reachedEnd = false;
     };
 
+    // Where the time went for the current image, for the performance overlay
+    struct ImageTimings
+    {
+        double statMs = 0.0;
+        double decodeMs = 0.0;
+        double colorConversionMs = 0.0;
+        double pixmapUploadMs = 0.0;
+        double expensiveScaleMs = 0.0;
+    };
+
     explicit QVImageCore(QObject *parent = nullptr);
 
     void loadFile(const QString &fileName, bool isReloading = false, const QString &baseDir = "", bool debouncePreloading = false);
+    void loadData(const QByteArray &data);
+    // Starts decoding a file that a core is about to be asked to load, before one exists
+    static void prefetchFile(const QString &fileName);
     void closeImage(const bool stayInDir = false);
     GoToFileResult goToFile(const Qv::GoToFileMode mode, const int index = 0);
     void markFolderInfoDirty() { folderInfoDirty = true; }
@@ -52,7 +73,7 @@ public:
     bool getSortDescending() const { return fileEnumerator.getSortDescending(); }
     void setSortDescending(const bool descending) { fileEnumerator.setSortDescending(descending); }
 
-    void settingsUpdated();
+    void settingsUpdated(const QSet<QString> &changedKeys);
 
     void jumpToNextFrame();
     void jumpToPreviousFrame();
@@ -61,14 +82,29 @@ public:
 
     QPixmap scaleExpensively(const QSizeF desiredSize);
 
+    // Starts building the smaller copies of the image that getMipmapLevel picks from
+    void requestMipmap();
+
+    QPixmap getMipmapLevel(const qreal scale) const;
+
     const QPixmap& getLoadedPixmap() const { return loadedPixmap; }
     const QVMovie& getLoadedMovie() const { return loadedMovie; }
     const FileDetails& getCurrentFileDetails() const { return currentFileDetails; }
     bool hasFileOrPendingLoad() const { return fileOrLoadPending; }
+    const ImageTimings& getImageTimings() const { return imageTimings; }
+    QVImageLoader::Stats getLoaderStats() const { return imageLoader.getStats(); }
+    qint64 getScaledCacheBytes() const { return qint64(scaledRenditionCache.totalCost()) * 1024 + scaledFrameCacheBytes; }
 
 signals:
+    // Holders of the loaded pixmap should release it, so the next frame can be painted into it
+    void animatedFrameAboutToChange();
+
     void animatedFrameChanged(QRect rect);
 
+    void scaledPixmapReady();
+
+    void mipmapReady();
+
     void fileChanging();
 
     void fileChanged();
@@ -76,6 +112,7 @@ signals:
     void sortParametersChanged();
 
 protected:
+    void requestSource(const QVImageLoader::Source &source, bool isReloading, bool debouncePreloading);
     void loadPixmap(const ReadData &readData);
     void loadEmptyPixmap();
     void updateFolderInfo(QString dirPath = QString());
@@ -84,22 +121,60 @@ protected:
     QColorSpace getTargetColorSpace() const;
     QColorSpace detectDisplayColorSpace() const;
     static void handleColorSpaceConversion(QImage &image, const QColorSpace &targetColorSpace);
+    static QString getAdjustedFileName(const QString &fileName);
+    static int getLargestScreenDimension();
+    int getCurrentScaledFrameNumber() const;
+    QString getScaledRenditionKey(const QSize &size) const;
+    void startExpensiveScaling(const QImage &image, const QSize &size, std::function<void(QImage, double)> onFinished);
+    void scaledFrameFinished(const int frameNumber, const quint64 generation, QImage scaledImage, const double elapsedMs);
+    void scaledRenditionFinished(const QString &key, QImage scaledImage, const double elapsedMs);
+    void clearScaledFrameCache();
+    void mipmapFinished(const quint64 generation, const QList<QImage> &levels);
+    void clearMipmap();
 
 private:
     QVFileEnumerator fileEnumerator {this};
     QVImageLoader imageLoader {this};
     QTimer preloadDebounceTimer {this};
 
+    QVImageLoader::Source loadedSource;
     QPixmap loadedPixmap;
     QVMovie loadedMovie;
+    // Feeds in-memory images to the movie, which can't read straight from a byte array
+    QBuffer loadedMovieBuffer;
 
     FileDetails currentFileDetails;
+    ImageTimings imageTimings;
+
+    // Expensively scaled static images, kept across zoom changes and navigation. Keys identify the
+    // file contents and the target size in device pixels, which covers the device pixel ratio.
+    QCache<QString, QPixmap> scaledRenditionCache {maxScaledRenditionCacheKilobytes};
+    QSet<QString> pendingScaledRenditions;
+    QString currentScaledRenditionKey;
+
+    // Expensively scaled animation frames for the most recently requested size
+    QHash<int, QPixmap> scaledFrameCache;
+    QSet<int> pendingScaledFrames;
+    QSize scaledFrameCacheSize;
+    qint64 scaledFrameCacheBytes {0};
+    quint64 scaledFrameGeneration {0};
+    std::shared_ptr<int> lifetimeToken = std::make_shared<int>(0);
+
+    // Successive half size reductions of a static image, built on demand for low zoom levels
+    QList<QPixmap> mipmapLevels;
+    bool mipmapRequested {false};
+    quint64 mipmapGeneration {0};
 
     Qv::PreloadMode preloadingMode {Qv::PreloadMode::Adjacent};
     Qv::ColorSpaceConversion colorSpaceConversion {Qv::ColorSpaceConversion::AutoDetect};
 
     int largestDimension {1920};
 
+    static constexpr qint64 maxAnimationCacheBytes {512LL * 1024 * 1024};
+    static constexpr qint64 maxScaledFrameCacheBytes {256LL * 1024 * 1024};
+    static constexpr qsizetype maxScaledRenditionCacheKilobytes {128 * 1024};
+    static constexpr int minimumMipmapDimension {64};
+
     quint64 pendingLoadRequestId = 0;
     bool loadInProgress {false};
     bool pendingLoadDebouncesPreloading {false};
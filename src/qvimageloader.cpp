@@ -1,12 +1,18 @@
 #include "qvimageloader.h"
+#include "qvmovie.h"
+#include "qvtrace.h"
 
+#include <QBuffer>
 #include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QFileInfo>
 #include <QImageReader>
 #include <QMetaObject>
 #include <QThreadPool>
 
-QVImageLoader::QVImageLoader(QObject *parent) : QObject(parent)
+QVImageLoader::QVImageLoader(QObject *parent) : QObject(parent), sharedCache(std::make_shared<SharedCache>())
 {
 }
 
@@ -20,18 +26,30 @@ void QVImageLoader::setLargestDimension(const int value)
     largestDimension = value;
 }
 
+void QVImageLoader::setSharedCache(const std::shared_ptr<SharedCache> &value)
+{
+    sharedCache = value;
+}
+
 quint64 QVImageLoader::requestImage(const QString &absoluteFilePath, const bool forceReload)
 {
-    const QString normalizedPath = normalizePath(absoluteFilePath);
-    const FileIdentity identity = getFileIdentity(normalizedPath);
+    return requestImage(Source::fromFile(absoluteFilePath), forceReload);
+}
+
+quint64 QVImageLoader::requestImage(const Source &source, const bool forceReload)
+{
+    const QString &key = source.key;
+    const FileIdentity identity = getFileIdentity(source);
 
-    auto targetEntryIt = entries.find(normalizedPath);
+    auto targetEntryIt = entries.find(key);
     if (targetEntryIt == entries.end())
     {
         Entry entry;
         entry.priority = 0;
         entry.expectedIdentity = identity;
-        targetEntryIt = entries.insert(normalizedPath, std::move(entry));
+        entry.source = source;
+        adoptPrefetch(key, entry);
+        targetEntryIt = entries.insert(key, std::move(entry));
     }
     else
     {
@@ -67,13 +85,20 @@ quint64 QVImageLoader::requestImage(const QString &absoluteFilePath, const bool
             targetEntry.state = State::Queued;
             targetEntry.result.reset();
         }
+        targetEntry.forceFresh = true;
     }
 
     const quint64 requestId = ++nextRequestId;
-    pendingRequest = PendingRequest {requestId, normalizedPath};
+    pendingRequest = PendingRequest {requestId, key};
+
+    requestCount++;
+    if (targetEntry.state == State::Cached)
+        cachedRequestCount++;
+    else if (targetEntry.state == State::Loading && !targetEntry.reloadAfterFinish)
+        loadingRequestCount++;
 
     if (targetEntry.state == State::Cached)
-        queueCachedDelivery(requestId, normalizedPath);
+        queueCachedDelivery(requestId, key);
 
     startReadyJobs();
     return requestId;
@@ -98,6 +123,95 @@ void QVImageLoader::clear()
     }
 }
 
+QVImageLoader::Stats QVImageLoader::getStats() const
+{
+    Stats stats;
+    stats.requestCount = requestCount;
+    stats.cachedRequestCount = cachedRequestCount;
+    stats.loadingRequestCount = loadingRequestCount;
+    stats.sharedJobCount = sharedJobCount;
+    for (const Entry &entry : entries)
+    {
+        switch (entry.state)
+        {
+        case State::Queued:
+            stats.queuedCount++;
+            break;
+        case State::Loading:
+            stats.loadingCount++;
+            break;
+        case State::Cached:
+            stats.cachedCount++;
+            if (entry.result.has_value())
+                stats.cachedBytes += getResultBytes(entry.result.value());
+            break;
+        }
+    }
+    return stats;
+}
+
+void QVImageLoader::prefetchImage(const QString &absoluteFilePath, const int largestDimension)
+{
+    const Source source = Source::fromFile(absoluteFilePath);
+    auto prefetch = std::make_shared<SharedDecode>();
+    prefetch->source = source;
+    prefetch->largestDimension = largestDimension;
+    prefetch->identity = getFileIdentity(source);
+    currentPrefetch = prefetch;
+    QVTrace::instant("QVImageLoader::prefetchImage", [&]{ return QJsonObject {{"path", source.key}}; });
+
+    SharedCache::run(prefetch, 0);
+}
+
+bool QVImageLoader::adoptPrefetch(const QString &key, Entry &entry)
+{
+    // Whether or not it matches, a prefetch is only ever offered to the first new request
+    const std::shared_ptr<SharedDecode> prefetch = std::exchange(currentPrefetch, {});
+    if (!prefetch || prefetch->source.key != key || prefetch->largestDimension != largestDimension)
+        return false;
+
+    if (prefetch->result.has_value() && getFileIdentity(prefetch->result.value()) != entry.expectedIdentity)
+        return false;
+
+    // From here on it's like any other decode in the cache, so other windows can find it too
+    sharedCache->add(prefetch);
+    entry.decode = prefetch;
+
+    if (prefetch->result.has_value())
+    {
+        entry.state = State::Cached;
+        entry.result = prefetch->result;
+        entry.result->preparedAnimation = copyPreparedAnimation(entry.result->preparedAnimation, true);
+        return true;
+    }
+
+    // Still decoding, so finish it as if it were one of our own jobs
+    entry.state = State::Loading;
+    entry.startedIdentity = entry.expectedIdentity;
+    prefetch->waiters.append({this, lifetimeToken, ++entry.generation});
+    return true;
+}
+
+QVImageLoader::Source QVImageLoader::Source::fromFile(const QString &filePath)
+{
+    const QString absoluteFilePath = normalizePath(filePath);
+    return {absoluteFilePath, absoluteFilePath, {}};
+}
+
+QVImageLoader::Source QVImageLoader::Source::fromData(const QByteArray &data)
+{
+    const QString key = "memory:" + QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+    return {key, {}, data};
+}
+
+QVImageLoader::Source QVImageLoader::Source::fromDevice(QIODevice *device)
+{
+    if (!device->isOpen() && !device->open(QIODevice::ReadOnly))
+        return fromData({});
+
+    return fromData(device->readAll());
+}
+
 bool QVImageLoader::FileIdentity::operator==(const FileIdentity &other) const
 {
     return fileSize == other.fileSize && lastModified == other.lastModified;
@@ -108,9 +222,13 @@ QString QVImageLoader::normalizePath(const QString &path)
     return QFileInfo(path).absoluteFilePath();
 }
 
-QVImageLoader::FileIdentity QVImageLoader::getFileIdentity(const QString &absoluteFilePath)
+QVImageLoader::FileIdentity QVImageLoader::getFileIdentity(const Source &source)
 {
-    const QFileInfo fileInfo(absoluteFilePath);
+    // The data can't change underneath us, and the key already covers its contents
+    if (source.isInMemory())
+        return {source.data.size(), {}};
+
+    const QFileInfo fileInfo(source.absoluteFilePath);
     return {fileInfo.size(), fileInfo.lastModified()};
 }
 
@@ -119,33 +237,62 @@ QVImageLoader::FileIdentity QVImageLoader::getFileIdentity(const Result &result)
     return {result.fileSize, result.lastModified};
 }
 
-QVImageLoader::Result QVImageLoader::readFile(const QString &absoluteFilePath, const int largestDimension)
+qint64 QVImageLoader::getResultBytes(const Result &result)
 {
-    QImageReader imageReader(absoluteFilePath);
-    imageReader.setAutoTransform(true);
+    qint64 bytes = result.image.sizeInBytes();
+    if (result.preparedAnimation)
+    {
+        // The first frame usually shares its pixels with the image
+        for (const QImage &frame : result.preparedAnimation->frames)
+        {
+            if (frame.cacheKey() != result.image.cacheKey())
+                bytes += frame.sizeInBytes();
+        }
+    }
+    return bytes;
+}
+
+QVImageLoader::Result QVImageLoader::readSource(const Source &source, const int largestDimension)
+{
+    QElapsedTimer decodeTimer;
+    decodeTimer.start();
+
+    QBuffer buffer;
+    auto imageReader = std::make_unique<QImageReader>();
+    if (source.isInMemory())
+    {
+        buffer.setData(source.data);
+        buffer.open(QIODevice::ReadOnly);
+        imageReader->setDevice(&buffer);
+    }
+    else
+    {
+        imageReader->setFileName(source.absoluteFilePath);
+    }
+    imageReader->setAutoTransform(true);
 
     bool isMultiFrameImage = false;
     QSize intrinsicSize;
     QImage image;
-    if ((imageReader.format() == "svg" || imageReader.format() == "svgz") && !imageReader.size().isEmpty())
+    if ((imageReader->format() == "svg" || imageReader->format() == "svgz") && !imageReader->size().isEmpty())
     {
-        intrinsicSize = imageReader.size();
-        imageReader.setScaledSize(intrinsicSize.scaled(largestDimension, largestDimension, Qt::KeepAspectRatio));
-        image = imageReader.read();
+        intrinsicSize = imageReader->size();
+        imageReader->setScaledSize(intrinsicSize.scaled(largestDimension, largestDimension, Qt::KeepAspectRatio));
+        image = imageReader->read();
     }
     else
     {
-        isMultiFrameImage = !imageReader.supportsOption(QImageIOHandler::Animation) && imageReader.imageCount() > 1;
-        image = imageReader.read();
+        isMultiFrameImage = !imageReader->supportsOption(QImageIOHandler::Animation) && imageReader->imageCount() > 1;
+        image = imageReader->read();
     }
 
     // Handle cases like icons containing multiple resolutions
     if (isMultiFrameImage)
     {
         qsizetype bestSize = image.sizeInBytes();
-        while (imageReader.jumpToNextImage())
+        while (imageReader->jumpToNextImage())
         {
-            QImage candidateImage = imageReader.read();
+            QImage candidateImage = imageReader->read();
             if (!candidateImage.isNull() && candidateImage.sizeInBytes() > bestSize)
             {
                 bestSize = candidateImage.sizeInBytes();
@@ -154,28 +301,106 @@ QVImageLoader::Result QVImageLoader::readFile(const QString &absoluteFilePath, c
         }
     }
 
-    const QFileInfo fileInfo(absoluteFilePath);
+    LoadTimings timings;
+    timings.decodeMs = decodeTimer.nsecsElapsed() / 1000000.0;
+
+    qint64 fileSize = source.data.size();
+    QDateTime lastModified;
+    if (!source.isInMemory())
+    {
+        QElapsedTimer statTimer;
+        statTimer.start();
+        const QFileInfo fileInfo(source.absoluteFilePath);
+        fileSize = fileInfo.size();
+        lastModified = fileInfo.lastModified();
+        timings.statMs = statTimer.nsecsElapsed() / 1000000.0;
+    }
 
     Result result {
         std::move(image),
-        fileInfo.absoluteFilePath(),
-        fileInfo.size(),
-        fileInfo.lastModified(),
+        source.absoluteFilePath,
+        source,
+        fileSize,
+        lastModified,
         isMultiFrameImage,
         intrinsicSize,
-        {}
+        {},
+        {},
+        timings
     };
 
     if (result.image.isNull())
-        result.errorData = ErrorData {imageReader.error(), imageReader.errorString()};
+        result.errorData = ErrorData {imageReader->error(), imageReader->errorString()};
+    else if (!isMultiFrameImage && !source.isInMemory() && imageReader->format() == "png")
+        result.preparedAnimation = prepareAnimatedPng(source.absoluteFilePath);
+    else if (!isMultiFrameImage && !source.isInMemory())
+        result.preparedAnimation = prepareAnimation(std::move(imageReader), result.image);
 
     return result;
 }
 
-bool QVImageLoader::isWanted(const QString &absoluteFilePath, const Entry &entry) const
+std::shared_ptr<QVImageLoader::PreparedAnimation> QVImageLoader::prepareAnimation(std::unique_ptr<QImageReader> reader, const QImage &firstFrame)
+{
+    if (!reader->supportsOption(QImageIOHandler::Animation))
+        return {};
+
+    // The reader has only read the first frame so far, so this is still its delay
+    const int firstFrameDelay = reader->nextImageDelay();
+    if (reader->imageCount() == 1 || !reader->canRead())
+        return {};
+
+    auto preparedAnimation = std::make_shared<PreparedAnimation>();
+    preparedAnimation->frameCount = reader->imageCount();
+    preparedAnimation->frames.append(firstFrame);
+    preparedAnimation->frameDelays.append(firstFrameDelay);
+    qsizetype decodedBytes = firstFrame.sizeInBytes();
+    while (preparedAnimation->frames.size() < preparedAnimationFrameLimit &&
+           decodedBytes < preparedAnimationByteLimit &&
+           reader->canRead())
+    {
+        QImage frame = reader->read();
+        if (frame.isNull())
+            break;
+        decodedBytes += frame.sizeInBytes();
+        preparedAnimation->frameDelays.append(reader->nextImageDelay());
+        preparedAnimation->frames.append(std::move(frame));
+    }
+
+    if (reader->format() == "gif" && !reader->fileName().isEmpty())
+    {
+        QFile file(reader->fileName());
+        if (file.open(QIODevice::ReadOnly))
+            preparedAnimation->frameUpdateRects = QVMovie::readGifUpdateRects(&file);
+    }
+
+    // The reader will carry on decoding on the UI thread
+    if (QIODevice *device = reader->device())
+        device->moveToThread(QCoreApplication::instance()->thread());
+
+    preparedAnimation->reader = std::move(reader);
+    return preparedAnimation;
+}
+
+std::shared_ptr<QVImageLoader::PreparedAnimation> QVImageLoader::prepareAnimatedPng(const QString &absoluteFilePath)
+{
+    // Same as the APNG workaround in QVImageCore. The default image of an APNG doesn't have to be
+    // part of the animation, so the still image stays what the png reader shows.
+    auto reader = std::make_unique<QImageReader>(absoluteFilePath, "apng");
+    reader->setAutoTransform(true);
+    if (!reader->supportsOption(QImageIOHandler::Animation) || reader->imageCount() <= 1)
+        return {};
+
+    const QImage firstFrame = reader->read();
+    if (firstFrame.isNull())
+        return {};
+
+    return prepareAnimation(std::move(reader), firstFrame);
+}
+
+bool QVImageLoader::isWanted(const QString &key, const Entry &entry) const
 {
     return entry.desired ||
-        (pendingRequest.has_value() && pendingRequest->absoluteFilePath == absoluteFilePath);
+        (pendingRequest.has_value() && pendingRequest->key == key);
 }
 
 void QVImageLoader::setDesiredImages(const QList<DesiredImage> &desiredImages)
@@ -184,17 +409,18 @@ void QVImageLoader::setDesiredImages(const QList<DesiredImage> &desiredImages)
     {
         int priority;
         FileIdentity identity;
+        Source source;
     };
 
     QHash<QString, DesiredEntry> desiredEntries;
     for (const DesiredImage &desiredImage : desiredImages)
     {
-        const QString absoluteFilePath = normalizePath(desiredImage.absoluteFilePath);
-        const FileIdentity identity = getFileIdentity(absoluteFilePath);
-        auto desiredIt = desiredEntries.find(absoluteFilePath);
+        const Source source = Source::fromFile(desiredImage.absoluteFilePath);
+        const FileIdentity identity = getFileIdentity(source);
+        auto desiredIt = desiredEntries.find(source.key);
         if (desiredIt == desiredEntries.end())
         {
-            desiredEntries.insert(absoluteFilePath, {desiredImage.priority, identity});
+            desiredEntries.insert(source.key, {desiredImage.priority, identity, source});
         }
         else
         {
@@ -244,33 +470,34 @@ void QVImageLoader::setDesiredImages(const QList<DesiredImage> &desiredImages)
         entry.desired = true;
         entry.priority = it->priority;
         entry.expectedIdentity = it->identity;
+        entry.source = it->source;
         entries.insert(it.key(), std::move(entry));
     }
 
     startReadyJobs();
 }
 
-void QVImageLoader::queueCachedDelivery(const quint64 requestId, const QString &absoluteFilePath)
+void QVImageLoader::queueCachedDelivery(const quint64 requestId, const QString &key)
 {
     QMetaObject::invokeMethod(
         this,
-        [this, requestId, absoluteFilePath]() {
-            deliverResult(requestId, absoluteFilePath);
+        [this, requestId, key]() {
+            deliverResult(requestId, key);
         },
         Qt::QueuedConnection
     );
 }
 
-void QVImageLoader::deliverResult(const quint64 requestId, const QString &absoluteFilePath)
+void QVImageLoader::deliverResult(const quint64 requestId, const QString &key)
 {
     if (!pendingRequest.has_value() ||
         pendingRequest->id != requestId ||
-        pendingRequest->absoluteFilePath != absoluteFilePath)
+        pendingRequest->key != key)
     {
         return;
     }
 
-    const auto entryIt = entries.constFind(absoluteFilePath);
+    const auto entryIt = entries.constFind(key);
     if (entryIt == entries.constEnd() || entryIt->state != State::Cached || !entryIt->result.has_value())
         return;
 
@@ -278,7 +505,11 @@ void QVImageLoader::deliverResult(const quint64 requestId, const QString &absolu
     pendingRequest.reset();
     emit imageReady(requestId, result);
 
-    const auto currentEntryIt = entries.find(absoluteFilePath);
+    // Whoever was going to claim the reader has done so by now, and a cached one would keep the file open
+    if (result.preparedAnimation)
+        result.preparedAnimation->reader.reset();
+
+    const auto currentEntryIt = entries.find(key);
     if (currentEntryIt != entries.end() &&
         currentEntryIt->state == State::Cached &&
         !currentEntryIt->desired)
@@ -311,26 +542,26 @@ void QVImageLoader::startReadyJobs()
         }
     }
 
-    QStringList pathsToStart;
+    QStringList keysToStart;
     for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
     {
         if (isWanted(it.key(), it.value()) &&
             it->state == State::Queued &&
             it->priority == nextPriority.value())
         {
-            pathsToStart.append(it.key());
+            keysToStart.append(it.key());
         }
     }
 
-    for (const QString &absoluteFilePath : std::as_const(pathsToStart))
-        startJob(absoluteFilePath);
+    for (const QString &key : std::as_const(keysToStart))
+        startJob(key);
 }
 
-void QVImageLoader::startJob(const QString &absoluteFilePath)
+void QVImageLoader::startJob(const QString &key)
 {
-    auto entryIt = entries.find(absoluteFilePath);
+    auto entryIt = entries.find(key);
     if (entryIt == entries.end() ||
-        !isWanted(absoluteFilePath, entryIt.value()) ||
+        !isWanted(key, entryIt.value()) ||
         entryIt->state != State::Queued)
     {
         return;
@@ -342,58 +573,58 @@ void QVImageLoader::startJob(const QString &absoluteFilePath)
     const quint64 generation = ++entryIt->generation;
     const int priority = entryIt->priority;
     const int targetLargestDimension = largestDimension;
-    emit loadStarted(absoluteFilePath, priority);
+    const Source source = entryIt->source;
+
+    // Another window may already have this image, or be working on it
+    std::shared_ptr<SharedDecode> decode;
+    if (!std::exchange(entryIt->forceFresh, false))
+        decode = sharedCache->find(source, targetLargestDimension, entryIt->startedIdentity);
+    if (decode)
+        sharedJobCount++;
+    else
+        decode = sharedCache->start(source, targetLargestDimension, entryIt->startedIdentity, priority);
+    entryIt->decode = decode;
 
-    QVImageLoader *loader = this;
-    const std::weak_ptr<int> weakLifetime = lifetimeToken;
-    QObject *dispatchContext = QCoreApplication::instance();
-    QThreadPool::globalInstance()->start(
-        [
-            loader,
-            weakLifetime,
-            dispatchContext,
-            absoluteFilePath,
-            generation,
-            targetLargestDimension
-        ]() {
-            Result result = readFile(absoluteFilePath, targetLargestDimension);
-            QMetaObject::invokeMethod(
-                dispatchContext,
-                [
-                    loader,
-                    weakLifetime,
-                    absoluteFilePath,
-                    generation,
-                    result = std::move(result)
-                ]() mutable {
-                    if (!weakLifetime.lock())
-                        return;
-                    loader->jobFinished(absoluteFilePath, generation, std::move(result));
-                },
-                Qt::QueuedConnection
-            );
-        },
-        -priority
-    );
+    if (decode->result.has_value())
+    {
+        QMetaObject::invokeMethod(
+            this,
+            [this, key, generation, result = decode->result.value()]() mutable {
+                jobFinished(key, generation, std::move(result));
+            },
+            Qt::QueuedConnection
+        );
+    }
+    else
+    {
+        decode->waiters.append({this, lifetimeToken, generation});
+    }
+
+    // Last, since handlers may change the entries
+    emit loadStarted(source.absoluteFilePath, priority);
+    QVTrace::instant("QVImageLoader::startJob", [&]{ return QJsonObject {{"path", key}, {"priority", priority}}; });
 }
 
-void QVImageLoader::jobFinished(const QString &absoluteFilePath, const quint64 generation, Result result)
+void QVImageLoader::jobFinished(const QString &key, const quint64 generation, Result result)
 {
-    auto entryIt = entries.find(absoluteFilePath);
+    QVTraceScope traceScope("QVImageLoader::jobFinished", [&]{ return QJsonObject {{"path", key}, {"decodeMs", result.timings.decodeMs}}; });
+
+    auto entryIt = entries.find(key);
     if (entryIt == entries.end() || entryIt->state != State::Loading || entryIt->generation != generation)
         return;
 
-    if (!isWanted(absoluteFilePath, entryIt.value()))
+    if (!isWanted(key, entryIt.value()))
     {
         entries.erase(entryIt);
         startReadyJobs();
         return;
     }
 
-    const FileIdentity currentIdentity = getFileIdentity(absoluteFilePath);
+    const FileIdentity currentIdentity = getFileIdentity(entryIt->source);
     if (entryIt->reloadAfterFinish || getFileIdentity(result) != currentIdentity)
     {
         entryIt->state = State::Queued;
+        entryIt->forceFresh = entryIt->reloadAfterFinish;
         entryIt->reloadAfterFinish = false;
         entryIt->expectedIdentity = currentIdentity;
         entryIt->result.reset();
@@ -404,9 +635,133 @@ void QVImageLoader::jobFinished(const QString &absoluteFilePath, const quint64 g
     entryIt->expectedIdentity = currentIdentity;
     entryIt->state = State::Cached;
     entryIt->result = std::move(result);
+    entryIt->result->preparedAnimation = copyPreparedAnimation(entryIt->result->preparedAnimation, pendingRequest.has_value() && pendingRequest->key == key);
 
-    if (pendingRequest.has_value() && pendingRequest->absoluteFilePath == absoluteFilePath)
-        deliverResult(pendingRequest->id, absoluteFilePath);
+    if (pendingRequest.has_value() && pendingRequest->key == key)
+        deliverResult(pendingRequest->id, key);
+    else
+        trimPreparedAnimation(key);
 
     startReadyJobs();
 }
+
+void QVImageLoader::trimPreparedAnimation(const QString &key)
+{
+    const auto entryIt = entries.find(key);
+    if (entryIt == entries.end() || !entryIt->result.has_value() || !entryIt->result->preparedAnimation)
+        return;
+
+    qint64 preparedBytes = 0;
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+    {
+        if (it->state == State::Cached && it->result.has_value())
+            preparedBytes += getResultBytes(it->result.value()) - it->result->image.sizeInBytes();
+    }
+    if (preparedBytes <= preparedAnimationCacheByteLimit)
+        return;
+
+    // Over budget, so this one will have to start from scratch when it's shown. The frames are
+    // our own copy, so other loaders sharing the decode keep theirs.
+    entryIt->result->preparedAnimation.reset();
+}
+
+std::shared_ptr<QVImageLoader::PreparedAnimation> QVImageLoader::copyPreparedAnimation(const std::shared_ptr<PreparedAnimation> &preparedAnimation, const bool takeReader)
+{
+    if (!preparedAnimation)
+        return {};
+
+    // Each loader gets its own copy, so trimming one never takes frames from another. Only the
+    // one about to show the image gets the reader, since preloads would keep the file locked on
+    // Windows for as long as the image stays cached; playback decodes past their frames later.
+    auto copy = std::make_shared<PreparedAnimation>();
+    copy->frameCount = preparedAnimation->frameCount;
+    copy->frames = preparedAnimation->frames;
+    copy->frameDelays = preparedAnimation->frameDelays;
+    copy->frameUpdateRects = preparedAnimation->frameUpdateRects;
+    if (takeReader)
+        copy->reader = std::move(preparedAnimation->reader);
+    return copy;
+}
+
+std::shared_ptr<QVImageLoader::SharedDecode> QVImageLoader::SharedCache::find(const Source &source, const int largestDimension, const FileIdentity &identity) const
+{
+    const std::shared_ptr<SharedDecode> decode = decodes.value(getCacheKey(source, largestDimension)).lock();
+    if (!decode || decode->identity != identity)
+        return {};
+
+    return decode;
+}
+
+std::shared_ptr<QVImageLoader::SharedDecode> QVImageLoader::SharedCache::start(const Source &source, const int largestDimension, const FileIdentity &identity, const int priority)
+{
+    auto decode = std::make_shared<SharedDecode>();
+    decode->source = source;
+    decode->largestDimension = largestDimension;
+    decode->identity = identity;
+    add(decode);
+    run(decode, priority);
+    return decode;
+}
+
+void QVImageLoader::SharedCache::add(const std::shared_ptr<SharedDecode> &decode)
+{
+    for (auto it = decodes.begin(); it != decodes.end();)
+    {
+        if (it->expired())
+            it = decodes.erase(it);
+        else
+            ++it;
+    }
+
+    decodes.insert(getCacheKey(decode->source, decode->largestDimension), decode);
+}
+
+void QVImageLoader::SharedCache::run(const std::shared_ptr<SharedDecode> &decode, const int priority)
+{
+    // The job holds on to the decode until it's done, even if everyone waiting on it gives up
+    QObject *dispatchContext = QCoreApplication::instance();
+    QThreadPool::globalInstance()->start(
+        [
+            decode,
+            dispatchContext
+        ]() {
+            QVTraceScope traceScope("QVImageLoader::readSource", [&]{ return QJsonObject {{"path", decode->source.key}}; });
+            Result result = readSource(decode->source, decode->largestDimension);
+            QMetaObject::invokeMethod(
+                dispatchContext,
+                [
+                    decode,
+                    result = std::move(result)
+                ]() mutable {
+                    finish(decode, std::move(result));
+                },
+                Qt::QueuedConnection
+            );
+        },
+        -priority
+    );
+}
+
+QString QVImageLoader::SharedCache::getCacheKey(const Source &source, const int largestDimension)
+{
+    return source.key + "|" + QString::number(largestDimension);
+}
+
+void QVImageLoader::SharedCache::finish(const std::shared_ptr<SharedDecode> &decode, Result result)
+{
+    decode->result = std::move(result);
+
+    const QList<SharedDecodeWaiter> waiters = std::exchange(decode->waiters, {});
+    for (const SharedDecodeWaiter &waiter : waiters)
+    {
+        const std::shared_ptr<int> lifetime = waiter.lifetime.lock();
+        if (!lifetime)
+            continue;
+        waiter.loader->jobFinished(decode->source.key, waiter.generation, decode->result.value());
+    }
+
+    // Whoever was about to show it has taken the reader by now. Only a prefetch that hasn't been
+    // adopted yet keeps it, for the window that's on its way.
+    if (decode->result->preparedAnimation && decode != currentPrefetch)
+        decode->result->preparedAnimation->reader.reset();
+}
@@ -6,6 +6,8 @@
 #include <QDateTime>
 #include <QHash>
 #include <QImage>
+#include <QImageReader>
+#include <QIODevice>
 #include <QObject>
 
 class QVImageLoader : public QObject
@@ -19,15 +21,52 @@ public:
         QString errorString;
     };
 
+    // What to decode. Files are identified by their path, while images that only exist in
+    // memory, like pasted or dropped image data, are identified by a hash of their contents.
+    struct Source
+    {
+        QString key;
+        QString absoluteFilePath;
+        QByteArray data;
+
+        bool isInMemory() const { return absoluteFilePath.isEmpty(); }
+
+        static Source fromFile(const QString &filePath);
+        static Source fromData(const QByteArray &data);
+        // Reads the rest of the device up front, so decoding never touches it from another thread
+        static Source fromDevice(QIODevice *device);
+    };
+
+    // The first few frames of an animation, along with a reader positioned just past them.
+    // Every loader gets its own copy, and only the request being shown gets the reader.
+    struct PreparedAnimation
+    {
+        std::unique_ptr<QImageReader> reader;
+        int frameCount = 0;
+        QList<QImage> frames;
+        QList<int> frameDelays;
+        // Worked out here for GIFs, so playback doesn't have to read the file again to find them
+        QList<QRect> frameUpdateRects;
+    };
+
+    struct LoadTimings
+    {
+        double statMs = 0.0;
+        double decodeMs = 0.0;
+    };
+
     struct Result
     {
         QImage image;
         QString absoluteFilePath;
+        Source source;
         qint64 fileSize = 0;
         QDateTime lastModified;
         bool isMultiFrameImage = false;
         QSize intrinsicSize;
         std::optional<ErrorData> errorData;
+        std::shared_ptr<PreparedAnimation> preparedAnimation;
+        LoadTimings timings;
     };
 
     struct DesiredImage
@@ -36,15 +75,42 @@ public:
         int priority = 0;
     };
 
+    struct Stats
+    {
+        int queuedCount = 0;
+        int loadingCount = 0;
+        int cachedCount = 0;
+        qint64 cachedBytes = 0;
+        // Requests that were already decoded, or already being decoded, thanks to preloading
+        quint64 requestCount = 0;
+        quint64 cachedRequestCount = 0;
+        quint64 loadingRequestCount = 0;
+        // Jobs that another loader sharing the cache had already decoded or started decoding
+        quint64 sharedJobCount = 0;
+    };
+
+    class SharedCache;
+
     explicit QVImageLoader(QObject *parent = nullptr);
     ~QVImageLoader() override;
 
     void setLargestDimension(int value);
 
+    // Loaders given the same cache, like those of different windows, decode each image once
+    // and share the pixels. Every loader starts out with a cache of its own.
+    void setSharedCache(const std::shared_ptr<SharedCache> &value);
+
+    quint64 requestImage(const Source &source, bool forceReload = false);
     quint64 requestImage(const QString &absoluteFilePath, bool forceReload = false);
     void setDesiredImages(const QList<DesiredImage> &desiredImages);
     void clear();
 
+    Stats getStats() const;
+
+    // Starts decoding a file before any loader exists to ask for it, such as the one given on
+    // the command line. The next loader to request an image takes over the result if it matches.
+    static void prefetchImage(const QString &absoluteFilePath, int largestDimension);
+
 signals:
     void imageReady(quint64 requestId, const QVImageLoader::Result &result);
     void loadStarted(const QString &absoluteFilePath, int priority);
@@ -59,6 +125,23 @@ private:
         bool operator!=(const FileIdentity &other) const { return !(*this == other); }
     };
 
+    struct SharedDecodeWaiter
+    {
+        QVImageLoader *loader = nullptr;
+        std::weak_ptr<int> lifetime;
+        quint64 generation = 0;
+    };
+
+    // A decode that any loader sharing the cache can attach to, kept alive by those using it
+    struct SharedDecode
+    {
+        Source source;
+        int largestDimension = 0;
+        FileIdentity identity;
+        std::optional<Result> result;
+        QList<SharedDecodeWaiter> waiters;
+    };
+
     enum class State
     {
         Queued,
@@ -75,33 +158,74 @@ private:
         FileIdentity expectedIdentity;
         FileIdentity startedIdentity;
         quint64 generation = 0;
+        bool forceFresh = false;
+        Source source;
         std::optional<Result> result;
+        std::shared_ptr<SharedDecode> decode;
     };
 
     struct PendingRequest
     {
         quint64 id;
-        QString absoluteFilePath;
+        QString key;
     };
 
     static QString normalizePath(const QString &path);
-    static FileIdentity getFileIdentity(const QString &absoluteFilePath);
+    static FileIdentity getFileIdentity(const Source &source);
     static FileIdentity getFileIdentity(const Result &result);
-    static Result readFile(const QString &absoluteFilePath, int largestDimension);
+    static qint64 getResultBytes(const Result &result);
+    static Result readSource(const Source &source, int largestDimension);
+    static std::shared_ptr<PreparedAnimation> prepareAnimation(std::unique_ptr<QImageReader> reader, const QImage &firstFrame);
 
-    bool isWanted(const QString &absoluteFilePath, const Entry &entry) const;
-    void queueCachedDelivery(quint64 requestId, const QString &absoluteFilePath);
-    void deliverResult(quint64 requestId, const QString &absoluteFilePath);
+    static std::shared_ptr<PreparedAnimation> prepareAnimatedPng(const QString &absoluteFilePath);
+    static std::shared_ptr<PreparedAnimation> copyPreparedAnimation(const std::shared_ptr<PreparedAnimation> &preparedAnimation, bool takeReader);
+
+    bool isWanted(const QString &key, const Entry &entry) const;
+    void queueCachedDelivery(quint64 requestId, const QString &key);
+    void deliverResult(quint64 requestId, const QString &key);
     void startReadyJobs();
-    void startJob(const QString &absoluteFilePath);
-    void jobFinished(const QString &absoluteFilePath, quint64 generation, Result result);
+    void startJob(const QString &key);
+    void jobFinished(const QString &key, quint64 generation, Result result);
+    bool adoptPrefetch(const QString &key, Entry &entry);
+    void trimPreparedAnimation(const QString &key);
 
     QHash<QString, Entry> entries;
     std::optional<PendingRequest> pendingRequest;
+    std::shared_ptr<SharedCache> sharedCache;
     std::shared_ptr<int> lifetimeToken = std::make_shared<int>(0);
 
     quint64 nextRequestId = 0;
+    quint64 requestCount = 0;
+    quint64 cachedRequestCount = 0;
+    quint64 loadingRequestCount = 0;
+    quint64 sharedJobCount = 0;
     int largestDimension = 1920;
+
+    // Only touched on the UI thread. Joins a loader's shared cache once adopted.
+    static inline std::shared_ptr<SharedDecode> currentPrefetch;
+
+    static constexpr int preparedAnimationFrameLimit = 8;
+    static constexpr qsizetype preparedAnimationByteLimit = 64 * 1024 * 1024;
+    static constexpr qint64 preparedAnimationCacheByteLimit = 128 * 1024 * 1024;
+};
+
+// Decodes in progress or finished, by source and size. Only weak references are kept here, so
+// an image is dropped as soon as the last loader holding it lets go.
+class QVImageLoader::SharedCache
+{
+public:
+    std::shared_ptr<SharedDecode> find(const Source &source, int largestDimension, const FileIdentity &identity) const;
+    std::shared_ptr<SharedDecode> start(const Source &source, int largestDimension, const FileIdentity &identity, int priority);
+
+private:
+    friend class QVImageLoader;
+
+    void add(const std::shared_ptr<SharedDecode> &decode);
+    static void run(const std::shared_ptr<SharedDecode> &decode, int priority);
+    static QString getCacheKey(const Source &source, int largestDimension);
+    static void finish(const std::shared_ptr<SharedDecode> &decode, Result result);
+
+    QHash<QString, std::weak_ptr<SharedDecode>> decodes;
 };
 
 Q_DECLARE_METATYPE(QVImageLoader::Result)
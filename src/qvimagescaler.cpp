@@ -0,0 +1,151 @@
+#include "qvimagescaler.h"
+#include <algorithm>
+#include <cmath>
+#include <QThread>
+#include <QtConcurrent/QtConcurrentRun>
+
+QImage QVImageScaler::scaled(const QImage &image, const QSize &size)
+{
+    if (image.isNull() || size.isEmpty())
+        return QImage();
+
+    if (size.width() > image.width() || size.height() > image.height())
+        return image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    // Averaging is only correct on premultiplied alpha, and the fast path only handles 8-bit channels
+    QImage source;
+    switch (image.format())
+    {
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+    case QImage::Format_RGBX8888:
+    case QImage::Format_RGBA8888_Premultiplied:
+        source = image;
+        break;
+    case QImage::Format_ARGB32:
+        source = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+        break;
+    case QImage::Format_RGBA8888:
+        source = image.convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+        break;
+    default:
+        return image.scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+    }
+
+    QImage target(size, source.format());
+    if (target.isNull())
+        return QImage();
+    target.setColorSpace(source.colorSpace());
+
+    const Contributions horizontal = calculateContributions(source.width(), size.width());
+    const Contributions vertical = calculateContributions(source.height(), size.height());
+    uchar *targetBits = target.bits();
+    const qsizetype targetBytesPerLine = target.bytesPerLine();
+
+    // Split the output rows between threads. Waiting on a future runs it here if the pool hasn't
+    // started it yet, so this is safe to call from a pool thread.
+    const int taskCount = std::clamp(size.height() / minimumRowsPerTask, 1, QThread::idealThreadCount());
+    const int rowsPerTask = (size.height() + taskCount - 1) / taskCount;
+    QList<QFuture<void>> futures;
+    for (int task = 1; task < taskCount; ++task)
+    {
+        const int firstRow = task * rowsPerTask;
+        const int endRow = std::min(firstRow + rowsPerTask, size.height());
+        if (firstRow >= endRow)
+            break;
+        futures.append(QtConcurrent::run([&, firstRow, endRow]() {
+            scaleRows(source, targetBits, targetBytesPerLine, horizontal, vertical, firstRow, endRow);
+        }));
+    }
+    scaleRows(source, targetBits, targetBytesPerLine, horizontal, vertical, 0, std::min(rowsPerTask, size.height()));
+    for (QFuture<void> &future : futures)
+        future.waitForFinished();
+
+    return target;
+}
+
+QVImageScaler::Contributions QVImageScaler::calculateContributions(const int sourceLength, const int targetLength)
+{
+    Contributions contributions;
+    contributions.firstIndex.reserve(targetLength);
+    contributions.weightOffset.reserve(targetLength + 1);
+
+    const double scale = double(sourceLength) / targetLength;
+    for (int i = 0; i < targetLength; ++i)
+    {
+        const double start = i * scale;
+        const double end = std::min((i + 1) * scale, double(sourceLength));
+        const int firstIndex = int(start);
+        const int lastIndex = std::min(int(std::ceil(end)), sourceLength) - 1;
+
+        contributions.firstIndex.append(firstIndex);
+        contributions.weightOffset.append(int(contributions.weights.size()));
+
+        qint64 total = 0;
+        qsizetype largest = contributions.weights.size();
+        for (int j = firstIndex; j <= lastIndex; ++j)
+        {
+            const double coverage = std::min(end, j + 1.0) - std::max(start, double(j));
+            const quint32 weight = quint32(std::lround(coverage / (end - start) * weightScale));
+            if (weight > contributions.weights.value(largest))
+                largest = contributions.weights.size();
+            contributions.weights.append(weight);
+            total += weight;
+        }
+
+        // Make the weights add up exactly so that flat areas come out unchanged
+        contributions.weights[largest] = quint32(contributions.weights.at(largest) + (qint64(weightScale) - total));
+    }
+    contributions.weightOffset.append(int(contributions.weights.size()));
+
+    return contributions;
+}
+
+void QVImageScaler::scaleRows(const QImage &source, uchar *targetBits, const qsizetype targetBytesPerLine,
+                              const Contributions &horizontal, const Contributions &vertical,
+                              const int firstRow, const int endRow)
+{
+    const int channelCount = source.width() * 4;
+    const int targetWidth = int(horizontal.firstIndex.size());
+    const qsizetype sourceBytesPerLine = source.bytesPerLine();
+    const uchar *sourceBits = source.constBits();
+
+    QList<quint32> columnSums(channelCount);
+    for (int y = firstRow; y < endRow; ++y)
+    {
+        // Vertical pass into 8.8 fixed point, which leaves headroom for the horizontal pass
+        std::fill(columnSums.begin(), columnSums.end(), 0);
+        const int firstWeight = vertical.weightOffset.at(y);
+        const int endWeight = vertical.weightOffset.at(y + 1);
+        for (int k = firstWeight; k < endWeight; ++k)
+        {
+            const uchar *sourceLine = sourceBits + (vertical.firstIndex.at(y) + (k - firstWeight)) * sourceBytesPerLine;
+            const quint32 weight = vertical.weights.at(k);
+            quint32 *sums = columnSums.data();
+            for (int i = 0; i < channelCount; ++i)
+                sums[i] += sourceLine[i] * weight;
+        }
+        for (quint32 &sum : columnSums)
+            sum = (sum + 128) >> 8;
+
+        // Horizontal pass
+        uchar *targetLine = targetBits + y * targetBytesPerLine;
+        for (int x = 0; x < targetWidth; ++x)
+        {
+            quint32 sums[4] = {1u << 23, 1u << 23, 1u << 23, 1u << 23};
+            const int firstPixelWeight = horizontal.weightOffset.at(x);
+            const int endPixelWeight = horizontal.weightOffset.at(x + 1);
+            for (int k = firstPixelWeight; k < endPixelWeight; ++k)
+            {
+                const quint32 *pixel = columnSums.constData() + (horizontal.firstIndex.at(x) + (k - firstPixelWeight)) * 4;
+                const quint32 weight = horizontal.weights.at(k);
+                sums[0] += pixel[0] * weight;
+                sums[1] += pixel[1] * weight;
+                sums[2] += pixel[2] * weight;
+                sums[3] += pixel[3] * weight;
+            }
+            for (int c = 0; c < 4; ++c)
+                targetLine[x * 4 + c] = uchar(sums[c] >> 24);
+        }
+    }
+}
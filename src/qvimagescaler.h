@@ -0,0 +1,32 @@
+#ifndef QVIMAGESCALER_H
+#define QVIMAGESCALER_H
+
+#include <QImage>
+#include <QSize>
+
+class QVImageScaler
+{
+public:
+    // High quality resampling for expensive scaling. Downscales are area-averaged across
+    // multiple threads; anything else falls back to Qt's smooth scaling.
+    static QImage scaled(const QImage &image, const QSize &size);
+
+private:
+    struct Contributions
+    {
+        QList<int> firstIndex;
+        QList<int> weightOffset;
+        QList<quint32> weights;
+    };
+
+    static Contributions calculateContributions(const int sourceLength, const int targetLength);
+
+    static void scaleRows(const QImage &source, uchar *targetBits, const qsizetype targetBytesPerLine,
+                          const Contributions &horizontal, const Contributions &vertical,
+                          const int firstRow, const int endRow);
+
+    static constexpr quint32 weightScale = 65536;
+    static constexpr int minimumRowsPerTask = 32;
+};
+
+#endif // QVIMAGESCALER_H
@@ -15,11 +15,18 @@
 #include "qbuffer.h"
 #include "qdir.h"
 
+#include <algorithm>
 #include <chrono>
 #include <map>
 #include <memory>
+#include <optional>
 
 #define QMOVIE_INVALID_DELAY -1
+#define QMOVIE_RECENT_FRAME_LIMIT 32
+#define QMOVIE_RECENT_FRAME_BUDGET (64 * 1024 * 1024)
+#define QMOVIE_SNAPSHOT_INTERVAL 16
+#define QMOVIE_SNAPSHOT_BUDGET (64 * 1024 * 1024)
+#define QMOVIE_LATE_FRAME_TOLERANCE std::chrono::milliseconds(10)
 
 QT_BEGIN_NAMESPACE
 
@@ -29,6 +36,7 @@ public:
     QPixmap pixmap;
     int delay;
     bool endMark;
+    QRect imageRect; // Where the decoder drew this frame, if it says
     inline QFrameInfo(bool endMark)
         : pixmap(QPixmap()), delay(QMOVIE_INVALID_DELAY), endMark(endMark)
     { }
@@ -37,8 +45,8 @@ public:
         : pixmap(QPixmap()), delay(QMOVIE_INVALID_DELAY), endMark(false)
     { }
 
-    inline QFrameInfo(QPixmap &&pixmap, int delay)
-        : pixmap(std::move(pixmap)), delay(delay), endMark(false)
+    inline QFrameInfo(QPixmap &&pixmap, int delay, const QRect &imageRect = QRect())
+        : pixmap(std::move(pixmap)), delay(delay), endMark(false), imageRect(imageRect)
     { }
 
     inline bool isValid()
@@ -71,6 +79,14 @@ public:
     int frameCount() const;
     bool jumpToNextFrame();
     QFrameInfo infoForFrame(int frameNumber);
+    QFrameInfo infoForAnimationFrame(int frameNumber);
+    bool rewindReader();
+    void addToRecentFrames(int frameNumber, const QFrameInfo &info);
+    void addSnapshot(int frameNumber, const QFrameInfo &info);
+    bool resumeFromSnapshot(int frameNumber);
+    void addDecodedFrames(const QList<QImage> &decodedFrames, const QList<int> &decodedFrameDelays);
+    bool skipToReaderFrame(int frameNumber);
+    QRect changedFrameRect(int previousFrameNumber, const QRect &previousImageRect);
     void reset();
     void cancelNextLoad();
 
@@ -82,6 +98,10 @@ public:
     void _q_loadNextFrame();
     void _q_loadNextFrame(bool starting);
 
+    void recordFrameTiming(std::chrono::steady_clock::time_point loadStartTime,
+                           std::optional<std::chrono::steady_clock::time_point> scheduledLoadTime,
+                           int scheduledDelay);
+
     QVMovie *q_ptr = nullptr;
     std::unique_ptr<QImageReader> reader = nullptr;
     int speed = 100;
@@ -89,6 +109,7 @@ public:
     QVMovie::MovieState movieState = QVMovie::NotRunning;
     QRect frameRect;
     QPixmap currentPixmap;
+    QRect currentImageRect;
     int currentFrameNumber = -1;
     int nextFrameNumber = 0;
     int greatestFrameNumber = -1;
@@ -102,6 +123,37 @@ public:
     std::map<int, QFrameInfo> frameMap;
     QString absoluteFilePath;
 
+    // What each GIF frame changes relative to the one before it, read from the frame
+    // descriptors since the handler doesn't report where it drew
+    std::optional<QList<QRect>> gifUpdateRects;
+
+    // Used with CacheNone: the most recently decoded contiguous run of composited frames,
+    // so stepping back within it is free
+    std::map<int, QFrameInfo> recentFrameMap;
+    int readerFrameNumber = 0;
+
+    // Also with CacheNone: composited frames at regular intervals, spaced out further whenever
+    // they go over budget. They're served as is, and a handler that can jump between images
+    // carries on from the one after the nearest snapshot. Others, like GIF, keep the compositing
+    // state to themselves, so anything before the recent run still decodes from the first frame.
+    std::map<int, QFrameInfo> snapshotMap;
+    int snapshotInterval = QMOVIE_SNAPSHOT_INTERVAL;
+    qint64 snapshotBytes = 0;
+
+    // Frame timing, for diagnosing playback that can't keep up
+    struct {
+        int frameCount = 0;
+        int lateFrameCount = 0;
+        int droppedFrameCount = 0;
+        int scheduledFrameCount = 0;
+        std::chrono::nanoseconds totalDecodeTime {0};
+        std::chrono::nanoseconds maxDecodeTime {0};
+        std::chrono::nanoseconds totalLateness {0};
+        std::chrono::nanoseconds totalFrameInterval {0};
+        qint64 totalScheduledDelay = 0;
+        std::optional<std::chrono::steady_clock::time_point> lastFrameTime;
+    } timing;
+
     QTimer *nextImageTimer = nullptr;
 };
 
@@ -133,7 +185,15 @@ void QVMoviePrivate::reset()
     playCounter = -1;
     haveReadAll = false;
     isFirstIteration = true;
+    currentImageRect = QRect();
     frameMap.clear();
+    gifUpdateRects.reset();
+    timing = {};
+    recentFrameMap.clear();
+    readerFrameNumber = 0;
+    snapshotMap.clear();
+    snapshotInterval = QMOVIE_SNAPSHOT_INTERVAL;
+    snapshotBytes = 0;
 }
 
 void QVMoviePrivate::cancelNextLoad()
@@ -179,31 +239,14 @@ QFrameInfo QVMoviePrivate::infoForFrame(int frameNumber)
     const auto nextFrameDelay = [&]() { return supportsAnimation ? reader->nextImageDelay() : 1000; };
 
     if (cacheMode == QVMovie::CacheNone) {
+        if (supportsAnimation)
+            return infoForAnimationFrame(frameNumber);
         if (frameNumber != currentFrameNumber+1) {
             // Non-sequential frame access
             if (!reader->jumpToImage(frameNumber)) {
-                if (frameNumber == 0) {
-                    // Special case: Attempt to "rewind" so we can loop
-                    // ### This could be implemented as QImageReader::rewind()
-                    if (reader->device()->isSequential())
-                        return QFrameInfo(); // Invalid
-                    QString fileName = reader->fileName();
-                    QByteArray format = reader->format();
-                    QIODevice *device = reader->device();
-                    QColor bgColor = reader->backgroundColor();
-                    QSize scaledSize = reader->scaledSize();
-                    if (fileName.isEmpty())
-                        reader = std::make_unique<QImageReader>(device, format);
-                    else
-                        reader = std::make_unique<QImageReader>(absoluteFilePath, format);
-                    if (!reader->canRead()) // Provoke a device->open() call
-                        emit q->error(reader->error());
-                    reader->device()->seek(initialDevicePos);
-                    reader->setBackgroundColor(bgColor);
-                    reader->setScaledSize(scaledSize);
-                } else {
+                // Special case: Attempt to "rewind" so we can loop
+                if (frameNumber != 0 || !rewindReader())
                     return QFrameInfo(); // Invalid
-                }
             }
         }
         if (stopAtFrame > 0 ? (frameNumber < stopAtFrame) : reader->canRead()) {
@@ -218,7 +261,7 @@ QFrameInfo QVMoviePrivate::infoForFrame(int frameNumber)
             }
             if (frameNumber > greatestFrameNumber)
                 greatestFrameNumber = frameNumber;
-            return QFrameInfo(QPixmap::fromImage(std::move(anImage)), nextFrameDelay());
+            return QFrameInfo(QPixmap::fromImage(std::move(anImage)), nextFrameDelay(), reader->currentImageRect());
         } else if (frameNumber != 0) {
             // We've read all frames now. Return an end marker
             haveReadAll = true;
@@ -234,6 +277,8 @@ QFrameInfo QVMoviePrivate::infoForFrame(int frameNumber)
     if (frameNumber > greatestFrameNumber) {
         // Frame hasn't been read from file yet. Try to do it
         for (int i = greatestFrameNumber + 1; i <= frameNumber; ++i) {
+            if (stopAtFrame < 0 && !skipToReaderFrame(i))
+                return QFrameInfo(); // Invalid
             if (stopAtFrame > 0 ? (frameNumber < stopAtFrame) : reader->canRead()) {
                 // reader says we can read. Attempt to actually read image
                 // But if it's a non-animated multi-frame format and we know the frame count, stop there.
@@ -244,8 +289,9 @@ QFrameInfo QVMoviePrivate::infoForFrame(int frameNumber)
                     // Reading image failed.
                     return QFrameInfo(); // Invalid
                 }
+                readerFrameNumber = i + 1;
                 greatestFrameNumber = i;
-                QFrameInfo info(QPixmap::fromImage(std::move(anImage)), nextFrameDelay());
+                QFrameInfo info(QPixmap::fromImage(std::move(anImage)), nextFrameDelay(), reader->currentImageRect());
                 // Cache it!
                 auto &e = frameMap[i] = std::move(info);
                 if (i == frameNumber) {
@@ -263,6 +309,164 @@ QFrameInfo QVMoviePrivate::infoForFrame(int frameNumber)
     return it == frameMap.cend() ? QFrameInfo() : it->second;
 }
 
+QFrameInfo QVMoviePrivate::infoForAnimationFrame(int frameNumber)
+{
+    // Recent frames are already composited, so they can be shown without
+    // touching the reader
+    if (const auto it = recentFrameMap.find(frameNumber); it != recentFrameMap.cend())
+        return it->second;
+    if (const auto it = snapshotMap.find(frameNumber); it != snapshotMap.cend())
+        return it->second;
+
+    if (resumeFromSnapshot(frameNumber)) {
+        // The reader is now at most one snapshot interval short of the frame
+    } else if (frameNumber != readerFrameNumber && reader->jumpToImage(frameNumber)) {
+        readerFrameNumber = frameNumber;
+    } else if (frameNumber < readerFrameNumber) {
+        // Animated formats generally can't seek backwards, so start over. The
+        // frames decoded on the way end up in the recent frame map, which makes
+        // further backward steps free until we run past the start of that run.
+        if (!rewindReader())
+            return QFrameInfo(); // Invalid
+    }
+
+    while (readerFrameNumber <= frameNumber) {
+        if (!reader->canRead()) {
+            // We've read all frames now. Return an end marker, unless there
+            // were no readable frames at all
+            haveReadAll = true;
+            if (frameNumber != 0 && frameNumber == greatestFrameNumber+1)
+                return QFrameInfo::endMarker();
+            return QFrameInfo(); // Invalid
+        }
+        QImage anImage = reader->read();
+        if (anImage.isNull()) {
+            // Reading image failed.
+            return QFrameInfo(); // Invalid
+        }
+        const int readFrameNumber = readerFrameNumber++;
+        if (readFrameNumber > greatestFrameNumber)
+            greatestFrameNumber = readFrameNumber;
+        QFrameInfo info(QPixmap::fromImage(std::move(anImage)), reader->nextImageDelay(), reader->currentImageRect());
+        addToRecentFrames(readFrameNumber, info);
+        addSnapshot(readFrameNumber, info);
+        if (readFrameNumber == frameNumber)
+            return info;
+    }
+    return QFrameInfo(); // Invalid
+}
+
+bool QVMoviePrivate::rewindReader()
+{
+    Q_Q(QVMovie);
+
+    // ### This could be implemented as QImageReader::rewind()
+    if (reader->device()->isSequential())
+        return false;
+    QString fileName = reader->fileName();
+    QByteArray format = reader->format();
+    QIODevice *device = reader->device();
+    QColor bgColor = reader->backgroundColor();
+    QSize scaledSize = reader->scaledSize();
+    bool autoTransform = reader->autoTransform();
+    if (fileName.isEmpty())
+        reader = std::make_unique<QImageReader>(device, format);
+    else
+        reader = std::make_unique<QImageReader>(absoluteFilePath, format);
+    if (!reader->canRead()) // Provoke a device->open() call
+        emit q->error(reader->error());
+    reader->device()->seek(initialDevicePos);
+    reader->setBackgroundColor(bgColor);
+    reader->setScaledSize(scaledSize);
+    reader->setAutoTransform(autoTransform);
+    readerFrameNumber = 0;
+    return true;
+}
+
+// Frames handed over without the reader that decoded them leave our reader behind, so
+// it has to read past them before it can produce the next one
+bool QVMoviePrivate::skipToReaderFrame(int frameNumber)
+{
+    while (readerFrameNumber < frameNumber) {
+        if (!reader->canRead() || reader->read().isNull())
+            return false;
+        ++readerFrameNumber;
+    }
+    return true;
+}
+
+void QVMoviePrivate::addDecodedFrames(const QList<QImage> &decodedFrames, const QList<int> &decodedFrameDelays)
+{
+    const int decodedFrameCount = int(std::min(decodedFrames.size(), decodedFrameDelays.size()));
+    for (int i = 0; i < decodedFrameCount; ++i) {
+        QFrameInfo info(QPixmap::fromImage(decodedFrames.at(i)), decodedFrameDelays.at(i));
+        if (cacheMode == QVMovie::CacheAll)
+            frameMap[i] = std::move(info);
+        else {
+            addToRecentFrames(i, info);
+            addSnapshot(i, info);
+        }
+    }
+    greatestFrameNumber = std::max(greatestFrameNumber, decodedFrameCount - 1);
+}
+
+static qint64 pixmapBytes(const QPixmap &pixmap)
+{
+    return qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+}
+
+void QVMoviePrivate::addToRecentFrames(int frameNumber, const QFrameInfo &info)
+{
+    const qint64 frameBytes = std::max(pixmapBytes(info.pixmap), qint64(1));
+
+    // Keep only a contiguous run of the most recent frames
+    if (!recentFrameMap.empty() && recentFrameMap.crbegin()->first != frameNumber-1)
+        recentFrameMap.clear();
+    recentFrameMap[frameNumber] = info;
+    const size_t maxRecentFrames = size_t(std::clamp<qint64>(QMOVIE_RECENT_FRAME_BUDGET / frameBytes, 1, QMOVIE_RECENT_FRAME_LIMIT));
+    while (recentFrameMap.size() > maxRecentFrames)
+        recentFrameMap.erase(recentFrameMap.begin());
+}
+
+void QVMoviePrivate::addSnapshot(int frameNumber, const QFrameInfo &info)
+{
+    if (frameNumber % snapshotInterval != 0 || snapshotMap.count(frameNumber))
+        return;
+
+    snapshotMap[frameNumber] = info;
+    snapshotBytes += pixmapBytes(info.pixmap);
+
+    // Over budget, so space them out further rather than stop taking them
+    while (snapshotBytes > QMOVIE_SNAPSHOT_BUDGET && snapshotMap.size() > 1) {
+        snapshotInterval *= 2;
+        for (auto it = snapshotMap.begin(); it != snapshotMap.end();) {
+            if (it->first % snapshotInterval != 0) {
+                snapshotBytes -= pixmapBytes(it->second.pixmap);
+                it = snapshotMap.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+// Positions the reader just past the nearest snapshot before the frame, if that's closer than
+// wherever the reader is now and the handler can jump there
+bool QVMoviePrivate::resumeFromSnapshot(int frameNumber)
+{
+    auto it = snapshotMap.upper_bound(frameNumber);
+    if (it == snapshotMap.cbegin())
+        return false;
+    const int resumeFrameNumber = std::prev(it)->first + 1;
+    if (readerFrameNumber <= frameNumber && readerFrameNumber >= resumeFrameNumber)
+        return false;
+
+    if (!reader->jumpToImage(resumeFrameNumber))
+        return false;
+    readerFrameNumber = resumeFrameNumber;
+    return true;
+}
+
 bool QVMoviePrivate::next()
 {
     QFrameInfo info = infoForFrame(nextFrameNumber);
@@ -292,6 +496,7 @@ bool QVMoviePrivate::next()
     // Image and delay OK, update internal state
     currentFrameNumber = nextFrameNumber++;
     currentPixmap = info.pixmap;
+    currentImageRect = info.imageRect;
 
     if (!speed)
         return true;
@@ -300,6 +505,107 @@ bool QVMoviePrivate::next()
     return true;
 }
 
+static bool skipGifSubBlocks(QIODevice *device)
+{
+    char size;
+    while (device->getChar(&size)) {
+        if (size == 0)
+            return true;
+        if (device->skip(quint8(size)) != quint8(size))
+            return false;
+    }
+    return false;
+}
+
+// Walks the blocks of a GIF without decoding anything, working out which part of the
+// canvas each frame can change: its own rect, plus the previous frame's if that one
+// was disposed of. Returns nothing if the file isn't understood.
+QList<QRect> QVMovie::readGifUpdateRects(QIODevice *device)
+{
+    const QByteArray header = device->read(13);
+    if (header.size() != 13 || !header.startsWith("GIF"))
+        return {};
+    const auto readWord = [](const char *data) { return int(quint8(data[0]) | (quint8(data[1]) << 8)); };
+    const QRect canvas(0, 0, readWord(header.constData() + 6), readWord(header.constData() + 8));
+    const quint8 screenFlags = quint8(header.at(10));
+    if ((screenFlags & 0x80) && device->skip(3 << ((screenFlags & 0x07) + 1)) != (3 << ((screenFlags & 0x07) + 1)))
+        return {};
+
+    QList<QRect> updateRects;
+    QRect previousRect;
+    int previousDisposal = 0;
+    int disposal = 0;
+    char introducer;
+    while (device->getChar(&introducer)) {
+        if (introducer == 0x3B) {
+            break;
+        } else if (introducer == 0x21) {
+            char label;
+            if (!device->getChar(&label))
+                return {};
+            if (quint8(label) == 0xF9) {
+                const QByteArray control = device->peek(2);
+                if (control.size() == 2 && control.at(0) >= 1)
+                    disposal = (quint8(control.at(1)) >> 2) & 0x07;
+            }
+            if (!skipGifSubBlocks(device))
+                return {};
+        } else if (introducer == 0x2C) {
+            const QByteArray descriptor = device->read(9);
+            if (descriptor.size() != 9)
+                return {};
+            const QRect rect = QRect(readWord(descriptor.constData()), readWord(descriptor.constData() + 2),
+                                     readWord(descriptor.constData() + 4), readWord(descriptor.constData() + 6)) & canvas;
+            const quint8 imageFlags = quint8(descriptor.at(8));
+            if ((imageFlags & 0x80) && device->skip(3 << ((imageFlags & 0x07) + 1)) != (3 << ((imageFlags & 0x07) + 1)))
+                return {};
+            // LZW minimum code size, then the image data
+            if (device->skip(1) != 1 || !skipGifSubBlocks(device))
+                return {};
+
+            // Restoring to the background (2) or to what was there before (3) touches the previous rect
+            if (updateRects.isEmpty())
+                updateRects.append(canvas);
+            else
+                updateRects.append(previousDisposal == 2 || previousDisposal == 3 ? rect | previousRect : rect);
+            previousRect = rect;
+            previousDisposal = disposal;
+            disposal = 0;
+        } else {
+            return {};
+        }
+    }
+    return updateRects;
+}
+
+QRect QVMoviePrivate::changedFrameRect(int previousFrameNumber, const QRect &previousImageRect)
+{
+    // Only a frame that follows on from the one shown builds on it
+    if (previousFrameNumber < 0 || currentFrameNumber != previousFrameNumber + 1 || reader->scaledSize().isValid())
+        return frameRect;
+
+    // Files are walked on the loader thread and handed over with setFrameUpdateRects(), so
+    // this only ever reads from memory
+    if (!gifUpdateRects.has_value()) {
+        gifUpdateRects = QList<QRect>();
+        const QBuffer *buffer = qobject_cast<QBuffer *>(reader->device());
+        if (reader->format() == "gif" && buffer) {
+            QBuffer gifData;
+            gifData.setData(buffer->data());
+            if (gifData.open(QIODevice::ReadOnly))
+                gifUpdateRects = QVMovie::readGifUpdateRects(&gifData);
+        }
+    }
+    if (currentFrameNumber < gifUpdateRects->size())
+        return gifUpdateRects->at(currentFrameNumber) & frameRect;
+
+    // Without knowing how the previous frame was disposed of, assume it could have been cleared
+    if (previousImageRect.isValid() && currentImageRect.isValid())
+        return (previousImageRect | currentImageRect) & frameRect;
+
+    return frameRect;
+}
+
 void QVMoviePrivate::_q_loadNextFrame()
 {
     _q_loadNextFrame(false);
@@ -309,18 +615,29 @@ void QVMoviePrivate::_q_loadNextFrame(bool starting)
 {
     Q_Q(QVMovie);
     const auto loadStartTime = std::chrono::steady_clock::now();
+    const auto scheduledLoadTime = movieState == QVMovie::Running ? nextLoadTime : std::nullopt;
+    const int scheduledDelay = nextDelay;
+    const int previousFrameNumber = currentFrameNumber;
+    const QRect previousImageRect = currentImageRect;
     if (next()) {
+        recordFrameTiming(loadStartTime, scheduledLoadTime, scheduledDelay);
+
         if (starting && movieState == QVMovie::NotRunning) {
             enterState(QVMovie::Running);
             emit q->started();
         }
 
+        bool isResized = false;
         if (frameRect.size() != currentPixmap.rect().size()) {
             frameRect = currentPixmap.rect();
+            isResized = true;
             emit q->resized(frameRect.size());
         }
 
-        emit q->updated(frameRect);
+        // Only report the part of the frame that can differ from the last one
+        const QRect changedRect = isResized ? frameRect : changedFrameRect(previousFrameNumber, previousImageRect);
+        if (!changedRect.isEmpty())
+            emit q->updated(changedRect);
         emit q->frameChanged(currentFrameNumber);
 
         if (speed && movieState == QVMovie::Running) {
@@ -329,6 +646,7 @@ void QVMoviePrivate::_q_loadNextFrame(bool starting)
             if (adjustedNextDelay < -1000) {
                 // If we get too far behind, don't try to catch up
                 nextLoadTime = std::nullopt;
+                timing.droppedFrameCount += -adjustedNextDelay / std::max(nextDelay, 1);
             }
             nextImageTimer->start(std::max(0, adjustedNextDelay));
         }
@@ -350,6 +668,30 @@ void QVMoviePrivate::_q_loadNextFrame(bool starting)
     }
 }
 
+void QVMoviePrivate::recordFrameTiming(std::chrono::steady_clock::time_point loadStartTime,
+                                       std::optional<std::chrono::steady_clock::time_point> scheduledLoadTime,
+                                       int scheduledDelay)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto decodeTime = now - loadStartTime;
+    timing.frameCount++;
+    timing.totalDecodeTime += decodeTime;
+    timing.maxDecodeTime = std::max<std::chrono::nanoseconds>(timing.maxDecodeTime, decodeTime);
+
+    // Lateness and frame rate are only meaningful for frames shown by the timer,
+    // not ones the user stepped to
+    if (scheduledLoadTime.has_value() && timing.lastFrameTime.has_value()) {
+        const auto lateness = std::max<std::chrono::nanoseconds>(loadStartTime - scheduledLoadTime.value(), std::chrono::nanoseconds(0));
+        timing.scheduledFrameCount++;
+        timing.totalLateness += lateness;
+        timing.totalFrameInterval += now - timing.lastFrameTime.value();
+        timing.totalScheduledDelay += scheduledDelay;
+        if (lateness > QMOVIE_LATE_FRAME_TOLERANCE)
+            timing.lateFrameCount++;
+    }
+    timing.lastFrameTime = now;
+}
+
 bool QVMoviePrivate::isValid() const
 {
     Q_Q(const QVMovie);
@@ -454,6 +796,37 @@ QString QVMovie::fileName() const
     return d->reader->fileName();
 }
 
+// Takes over a reader that has already produced the given frames, so playback
+// can begin without decoding them again. Set the cache mode beforehand.
+void QVMovie::setPreparedReader(std::unique_ptr<QImageReader> reader, const QList<QImage> &decodedFrames,
+                                const QList<int> &decodedFrameDelays)
+{
+    Q_D(QVMovie);
+    d->reader = std::move(reader);
+    d->absoluteFilePath = QDir(d->reader->fileName()).absolutePath();
+    d->reset();
+    d->initialDevicePos = 0;
+    d->addDecodedFrames(decodedFrames, decodedFrameDelays);
+    d->readerFrameNumber = d->greatestFrameNumber + 1;
+}
+
+// Seeds the first frames of the current file or device, decoded elsewhere, so playback can
+// begin without waiting on them. The reader still starts from the beginning and reads past
+// them once playback gets further. Set the cache mode beforehand.
+void QVMovie::setDecodedFrames(const QList<QImage> &decodedFrames, const QList<int> &decodedFrameDelays)
+{
+    Q_D(QVMovie);
+    d->addDecodedFrames(decodedFrames, decodedFrameDelays);
+}
+
+// Which part of the canvas each frame can change, as worked out by readGifUpdateRects().
+// Set after the file, device or prepared reader.
+void QVMovie::setFrameUpdateRects(const QList<QRect> &updateRects)
+{
+    Q_D(QVMovie);
+    d->gifUpdateRects = updateRects;
+}
+
 void QVMovie::setFormat(const QByteArray &format)
 {
     Q_D(QVMovie);
@@ -478,6 +851,18 @@ QColor QVMovie::backgroundColor() const
     return d->reader->backgroundColor();
 }
 
+void QVMovie::setAutoTransform(bool enabled)
+{
+    Q_D(QVMovie);
+    d->reader->setAutoTransform(enabled);
+}
+
+bool QVMovie::autoTransform() const
+{
+    Q_D(const QVMovie);
+    return d->reader->autoTransform();
+}
+
 QVMovie::MovieState QVMovie::state() const
 {
     Q_D(const QVMovie);
@@ -653,4 +1038,25 @@ void QVMovie::setCacheMode(CacheMode cacheMode)
     d->cacheMode = cacheMode;
 }
 
+QVMovie::FrameTimingStats QVMovie::frameTimingStats() const
+{
+    Q_D(const QVMovie);
+    using MillisecondsF = std::chrono::duration<double, std::milli>;
+    const auto &timing = d->timing;
+    FrameTimingStats stats;
+    stats.frameCount = timing.frameCount;
+    stats.lateFrameCount = timing.lateFrameCount;
+    stats.droppedFrameCount = timing.droppedFrameCount;
+    stats.maxDecodeMs = MillisecondsF(timing.maxDecodeTime).count();
+    if (timing.frameCount > 0)
+        stats.averageDecodeMs = MillisecondsF(timing.totalDecodeTime).count() / timing.frameCount;
+    if (timing.scheduledFrameCount > 0)
+        stats.averageLatenessMs = MillisecondsF(timing.totalLateness).count() / timing.scheduledFrameCount;
+    if (timing.totalScheduledDelay > 0)
+        stats.intendedFps = timing.scheduledFrameCount * 1000.0 / timing.totalScheduledDelay;
+    if (timing.totalFrameInterval.count() > 0)
+        stats.effectiveFps = timing.scheduledFrameCount * 1000.0 / MillisecondsF(timing.totalFrameInterval).count();
+    return stats;
+}
+
 QT_END_NAMESPACE
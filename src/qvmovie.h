@@ -13,6 +13,8 @@
 #include <QtCore/qscopedpointer.h>
 #include <QtGui/qimagereader.h>
 
+#include <memory>
+
 QT_REQUIRE_CONFIG(movie);
 
 QT_BEGIN_NAMESPACE
@@ -45,12 +47,24 @@ public:
     };
     Q_ENUM(CacheMode)
 
+    struct FrameTimingStats {
+        int frameCount = 0;
+        int lateFrameCount = 0;
+        int droppedFrameCount = 0;
+        double averageDecodeMs = 0.0;
+        double maxDecodeMs = 0.0;
+        double averageLatenessMs = 0.0;
+        double intendedFps = 0.0;
+        double effectiveFps = 0.0;
+    };
+
     explicit QVMovie(QObject *parent = nullptr);
     explicit QVMovie(QIODevice *device, const QByteArray &format = QByteArray(), QObject *parent = nullptr);
     explicit QVMovie(const QString &fileName, const QByteArray &format = QByteArray(), QObject *parent = nullptr);
     ~QVMovie();
 
     static QList<QByteArray> supportedFormats();
+    static QList<QRect> readGifUpdateRects(QIODevice *device);
 
     void setDevice(QIODevice *device);
     QIODevice *device() const;
@@ -58,12 +72,20 @@ public:
     void setFileName(const QString &fileName);
     QString fileName() const;
 
+    void setPreparedReader(std::unique_ptr<QImageReader> reader, const QList<QImage> &decodedFrames,
+                           const QList<int> &decodedFrameDelays);
+    void setDecodedFrames(const QList<QImage> &decodedFrames, const QList<int> &decodedFrameDelays);
+    void setFrameUpdateRects(const QList<QRect> &updateRects);
+
     void setFormat(const QByteArray &format);
     QByteArray format() const;
 
     void setBackgroundColor(const QColor &color);
     QColor backgroundColor() const;
 
+    void setAutoTransform(bool enabled);
+    bool autoTransform() const;
+
     MovieState state() const;
 
     QRect frameRect() const;
@@ -88,6 +110,9 @@ public:
     CacheMode cacheMode() const;
     void setCacheMode(CacheMode mode);
 
+    // Reset whenever a new file, device or prepared reader is set
+    FrameTimingStats frameTimingStats() const;
+
 Q_SIGNALS:
     void started();
     void resized(const QSize &size);
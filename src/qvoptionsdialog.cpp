@@ -33,6 +33,9 @@ QVOptionsDialog::QVOptionsDialog(QWidget *parent) :
     connect(ui->fitZoomLimitCheckbox, &QCheckBox::checkStateChanged, this, &QVOptionsDialog::fitZoomLimitCheckboxCheckStateChanged);
     connect(ui->constrainImagePositionCheckbox, &QCheckBox::checkStateChanged, this, &QVOptionsDialog::constrainImagePositionCheckboxCheckStateChanged);
     connect(ui->cursorAutoHideFullscreenCheckbox, &QCheckBox::checkStateChanged, this, &QVOptionsDialog::cursorAutoHideFullscreenCheckboxCheckStateChanged);
+#ifndef Q_OS_MACOS
+    connect(ui->singleInstanceCheckbox, &QCheckBox::checkStateChanged, this, &QVOptionsDialog::singleInstanceCheckboxCheckStateChanged);
+#endif
     connect(ui->middleButtonModeClickRadioButton, &QRadioButton::clicked, this, &QVOptionsDialog::middleButtonModeChanged);
     connect(ui->middleButtonModeDragRadioButton, &QRadioButton::clicked, this, &QVOptionsDialog::middleButtonModeChanged);
     connect(ui->titlebarComboBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &QVOptionsDialog::titlebarComboBoxCurrentIndexChanged);
@@ -60,8 +63,8 @@ QVOptionsDialog::QVOptionsDialog(QWidget *parent) :
     // Platform specific settings
 #ifdef Q_OS_MACOS
     ui->menubarCheckbox->hide();
+    ui->singleInstanceCheckbox->hide();
 #else
-    ui->reuseWindowCheckbox->hide();
     ui->darkTitlebarCheckbox->hide();
     ui->quitOnLastWindowCheckbox->hide();
 #endif
@@ -202,6 +205,11 @@ void QVOptionsDialog::syncSettings(bool defaults, bool makeConnections)
     syncCheckbox(ui->submenuIconsCheckbox, "submenuicons", defaults, makeConnections);
     // slideshowkeepswindowontop
     syncCheckbox(ui->slideshowKeepsWindowOnTopCheckbox, "slideshowkeepswindowontop", defaults, makeConnections);
+    // singleinstance
+    syncCheckbox(ui->singleInstanceCheckbox, "singleinstance", defaults, makeConnections);
+#ifndef Q_OS_MACOS
+    singleInstanceCheckboxCheckStateChanged(ui->singleInstanceCheckbox->checkState());
+#endif
     // reusewindow
     syncCheckbox(ui->reuseWindowCheckbox, "reusewindow", defaults, makeConnections);
     // persistsession
@@ -240,6 +248,8 @@ void QVOptionsDialog::syncSettings(bool defaults, bool makeConnections)
     syncCheckbox(ui->originalSizeAsToggleCheckbox, "originalsizeastoggle", defaults, makeConnections);
     // colorspaceconversion
     syncComboBox(ui->colorSpaceConversionComboBox, "colorspaceconversion", defaults, makeConnections);
+    // hardwareacceleration
+    syncCheckbox(ui->hardwareAccelerationCheckbox, "hardwareacceleration", defaults, makeConnections);
     // language
     syncComboBox(ui->langComboBox, "language", defaults, makeConnections);
     // sortmode
@@ -596,6 +606,12 @@ void QVOptionsDialog::cursorAutoHideFullscreenCheckboxCheckStateChanged(Qt::Chec
     ui->cursorAutoHideFullscreenDelaySpinBox->setEnabled(static_cast<bool>(state));
 }
 
+void QVOptionsDialog::singleInstanceCheckboxCheckStateChanged(Qt::CheckState state)
+{
+    // Launching with an image only goes through an existing window when it's forwarded there
+    ui->reuseWindowCheckbox->setEnabled(static_cast<bool>(state));
+}
+
 void QVOptionsDialog::customizePalette()
 {
     const QString currentStyle = qApp->style()->objectName();
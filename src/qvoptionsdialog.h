@@ -87,6 +87,8 @@ private slots:
 
     void cursorAutoHideFullscreenCheckboxCheckStateChanged(Qt::CheckState state);
 
+    void singleInstanceCheckboxCheckStateChanged(Qt::CheckState state);
+
     void languageComboBoxCurrentIndexChanged(int index);
 
     void formatsItemChanged(QTableWidgetItem *item);
@@ -0,0 +1,136 @@
+#include "qvsingleinstance.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QLocalSocket>
+
+#ifdef WIN32_LOADED
+#include <qt_windows.h>
+#endif
+
+QVSingleInstance::QVSingleInstance(QObject *parent) : QObject(parent)
+{
+}
+
+bool QVSingleInstance::forwardToRunningInstance(const QStringList &files)
+{
+    QLocalSocket socket;
+    socket.connectToServer(getServerName());
+    if (!socket.waitForConnected(connectTimeoutMs))
+        return false;
+
+#ifdef WIN32_LOADED
+    // We were just launched by the shell, so we're allowed to come to the front; pass that on so
+    // the running instance's window doesn't only flash in the taskbar
+    AllowSetForegroundWindow(ASFW_ANY);
+#endif
+
+    QByteArray message;
+    QDataStream out(&message, QIODevice::WriteOnly);
+    out.setVersion(dataStreamVersion);
+    out << messageMagic << protocolVersion << quint32(files.size());
+    for (const auto &file : files)
+        out << file;
+    socket.write(message);
+
+    // A hung instance still accepts connections and data, so it only counts as handed off once
+    // the running instance says it opened the files
+    while (socket.bytesAvailable() < 1)
+    {
+        if (!socket.waitForReadyRead(replyTimeoutMs))
+            return false;
+    }
+    return true;
+}
+
+void QVSingleInstance::setListening(const bool listening)
+{
+    if (listening == (server != nullptr))
+        return;
+
+    if (!listening)
+    {
+        server->close();
+        server->deleteLater();
+        server = nullptr;
+        return;
+    }
+
+    const QString serverName = getServerName();
+    server = new QLocalServer(this);
+    server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(server, &QLocalServer::newConnection, this, &QVSingleInstance::onNewConnection);
+
+    if (!server->listen(serverName) && server->serverError() == QAbstractSocket::AddressInUseError)
+    {
+        // Another instance already has it, unless it's a leftover from one that crashed. An instance
+        // that's just slow to answer still owns the name, so only take it over if nobody's there.
+        QLocalSocket socket;
+        socket.connectToServer(serverName);
+        if (!socket.waitForConnected(connectTimeoutMs) &&
+            (socket.error() == QLocalSocket::ServerNotFoundError || socket.error() == QLocalSocket::ConnectionRefusedError))
+        {
+            QLocalServer::removeServer(serverName);
+            server->listen(serverName);
+        }
+    }
+
+    if (!server->isListening())
+    {
+        server->deleteLater();
+        server = nullptr;
+    }
+}
+
+void QVSingleInstance::onNewConnection()
+{
+    while (QLocalSocket *socket = server->nextPendingConnection())
+    {
+        connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]{
+            if (socket->bytesAvailable() > maxMessageBytes)
+            {
+                socket->abort();
+                return;
+            }
+
+            QDataStream in(socket);
+            in.setVersion(dataStreamVersion);
+            in.startTransaction();
+            quint32 magic {0};
+            quint16 version {0};
+            quint32 fileCount {0};
+            in >> magic >> version >> fileCount;
+            if (in.status() == QDataStream::Ok && (magic != messageMagic || version != protocolVersion || fileCount > maxFileCount))
+            {
+                in.abortTransaction();
+                socket->abort();
+                return;
+            }
+
+            QStringList files;
+            for (quint32 i = 0; i < fileCount && in.status() == QDataStream::Ok; ++i)
+            {
+                QString file;
+                in >> file;
+                files << file;
+            }
+            if (!in.commitTransaction())
+                return;
+
+            emit filesReceived(files);
+            socket->write("\1", 1);
+            socket->flush();
+            socket->disconnectFromServer();
+        });
+    }
+}
+
+QString QVSingleInstance::getServerName()
+{
+    // Unique per user, since the name is global on some platforms
+    const QByteArray userKey = QDir::homePath().toUtf8();
+    return QString("%1-%2").arg(QCoreApplication::applicationName(), QString::fromLatin1(QCryptographicHash::hash(userKey, QCryptographicHash::Sha1).toHex().left(16)));
+}
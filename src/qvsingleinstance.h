@@ -0,0 +1,47 @@
+#ifndef QVSINGLEINSTANCE_H
+#define QVSINGLEINSTANCE_H
+
+#include <QDataStream>
+#include <QLocalServer>
+#include <QObject>
+#include <QStringList>
+
+// Lets a newly launched process hand its files to an instance that is already running, which
+// skips the cost of starting up a second time. Only an instance with the setting enabled listens.
+class QVSingleInstance : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QVSingleInstance(QObject *parent = nullptr);
+
+    // Returns true if a running instance opened the files. An empty list asks for a new window.
+    // Works before any application object exists.
+    static bool forwardToRunningInstance(const QStringList &files);
+
+    void setListening(const bool listening);
+
+signals:
+    void filesReceived(const QStringList &files);
+
+protected:
+    void onNewConnection();
+
+    static QString getServerName();
+
+private:
+    QLocalServer *server {nullptr};
+
+    static constexpr int connectTimeoutMs {250};
+    static constexpr int replyTimeoutMs {2000};
+
+    // Builds with a different protocol, or a different Qt, refuse each other's messages rather than
+    // misreading them
+    static constexpr quint32 messageMagic {0x71566931};
+    static constexpr quint16 protocolVersion {1};
+    static constexpr QDataStream::Version dataStreamVersion {QDataStream::Qt_6_0};
+    static constexpr quint32 maxFileCount {64};
+    static constexpr qint64 maxMessageBytes {1024 * 1024};
+};
+
+#endif // QVSINGLEINSTANCE_H
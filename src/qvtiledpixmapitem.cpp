@@ -0,0 +1,227 @@
+#include "qvtiledpixmapitem.h"
+#include <cmath>
+#include <QPainter>
+#include <QPaintEngine>
+#include <QStyleOptionGraphicsItem>
+
+#ifdef OPENGL_LOADED
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#endif
+
+QVTiledPixmapItem::QVTiledPixmapItem(QGraphicsItem *parent) : QGraphicsItem(parent)
+{
+    // Needed for an accurate exposed rect, which is what limits painting to the visible tiles
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+void QVTiledPixmapItem::setPixmap(const QPixmap &pixmap)
+{
+    if (pixmap.cacheKey() == currentPixmap.cacheKey())
+        return;
+
+    if (pixmap.size() != pixmapSize)
+    {
+        prepareGeometryChange();
+        pixmapSize = pixmap.size();
+    }
+
+    currentPixmap = pixmap;
+    pixmapReleased = false;
+    clearTiles();
+    update();
+}
+
+void QVTiledPixmapItem::updatePixmap(const QPixmap &pixmap, const QRect &rect)
+{
+    if (pixmap.size() != pixmapSize)
+    {
+        setPixmap(pixmap);
+        return;
+    }
+
+    currentPixmap = pixmap;
+    pixmapReleased = false;
+
+    // Filtering spreads a changed pixel into its neighbours
+    const QRect changedRect = rect.adjusted(-deviceTileSourceMargin, -deviceTileSourceMargin, deviceTileSourceMargin, deviceTileSourceMargin) & currentPixmap.rect();
+    invalidateTiles(changedRect);
+    update(QRectF(changedRect));
+}
+
+void QVTiledPixmapItem::releasePixmap()
+{
+    currentPixmap = QPixmap();
+    pixmapReleased = true;
+}
+
+void QVTiledPixmapItem::setTransformationMode(const Qt::TransformationMode mode)
+{
+    if (mode == currentTransformationMode)
+        return;
+
+    currentTransformationMode = mode;
+    deviceTiles.clear();
+    update();
+}
+
+QRectF QVTiledPixmapItem::boundingRect() const
+{
+    return QRectF(QPointF(), pixmapSize);
+}
+
+void QVTiledPixmapItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+{
+    Q_UNUSED(widget)
+
+    const QRectF exposedRect = option->exposedRect & boundingRect();
+    if (currentPixmap.isNull() || exposedRect.isEmpty())
+        return;
+
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, currentTransformationMode == Qt::SmoothTransformation);
+
+    // OpenGL filters textures cheaply, so there the pixmap only needs splitting up to keep within
+    // texture size limits; the raster engine benefits from reusing its transformed output instead
+    const QPaintEngine::Type engineType = painter->paintEngine()->type();
+    if (engineType == QPaintEngine::OpenGL2 || engineType == QPaintEngine::OpenGL)
+        paintSourceTiles(painter, exposedRect);
+    else
+        paintDeviceTiles(painter, exposedRect);
+}
+
+void QVTiledPixmapItem::paintSourceTiles(QPainter *painter, const QRectF &exposedRect)
+{
+    const int maxSingleTextureSize = getMaxTextureSize();
+    if (currentPixmap.width() <= maxSingleTextureSize && currentPixmap.height() <= maxSingleTextureSize)
+    {
+        painter->drawPixmap(QPointF(), currentPixmap);
+        return;
+    }
+
+    const QRect itemRect = exposedRect.toAlignedRect() & currentPixmap.rect();
+    QSet<QPoint> visibleTiles;
+    for (int row = itemRect.top() / sourceTileSize; row <= itemRect.bottom() / sourceTileSize; ++row)
+    {
+        for (int column = itemRect.left() / sourceTileSize; column <= itemRect.right() / sourceTileSize; ++column)
+        {
+            const QPoint tile(column, row);
+            const QRect tileRect = QRect(column * sourceTileSize, row * sourceTileSize, sourceTileSize, sourceTileSize) & currentPixmap.rect();
+            const QRect paddedRect = tileRect.adjusted(-sourceTileOverlap, -sourceTileOverlap, sourceTileOverlap, sourceTileOverlap) & currentPixmap.rect();
+
+            auto it = sourceTiles.find(tile);
+            if (it == sourceTiles.end())
+                it = sourceTiles.insert(tile, currentPixmap.copy(paddedRect));
+            visibleTiles.insert(tile);
+
+            const QRectF sourceRect(tileRect.topLeft() - paddedRect.topLeft(), tileRect.size());
+            painter->drawPixmap(QRectF(tileRect), it.value(), sourceRect);
+        }
+    }
+
+    if (sourceTiles.size() > maxSourceTiles)
+        sourceTiles.removeIf([&visibleTiles](QHash<QPoint, QPixmap>::iterator it) { return !visibleTiles.contains(it.key()); });
+}
+
+void QVTiledPixmapItem::paintDeviceTiles(QPainter *painter, const QRectF &exposedRect)
+{
+    const QTransform transform = painter->deviceTransform();
+
+    // Nothing to resample if the pixmap lands on whole device pixels at its natural size
+    if (transform.type() == QTransform::TxTranslate && transform.dx() == std::floor(transform.dx()) && transform.dy() == std::floor(transform.dy()))
+    {
+        painter->drawPixmap(exposedRect, currentPixmap, exposedRect);
+        return;
+    }
+
+    const QPoint origin(int(std::floor(transform.dx())), int(std::floor(transform.dy())));
+    const QTransform tileTransform = transform * QTransform::fromTranslate(-origin.x(), -origin.y());
+    if (tileTransform != deviceTileTransform)
+    {
+        deviceTiles.clear();
+        deviceTileTransform = tileTransform;
+    }
+
+    // Work in device pixels from here on, with the origin at the grid's anchor
+    const qreal devicePixelRatio = painter->device()->devicePixelRatio();
+    painter->save();
+    painter->setWorldTransform(QTransform::fromTranslate(origin.x(), origin.y()) * QTransform::fromScale(1.0 / devicePixelRatio, 1.0 / devicePixelRatio));
+
+    const QRect deviceRect = tileTransform.mapRect(exposedRect).toAlignedRect();
+    QSet<QPoint> visibleTiles;
+    for (int row = floorDivide(deviceRect.top(), deviceTileSize); row <= floorDivide(deviceRect.bottom(), deviceTileSize); ++row)
+    {
+        for (int column = floorDivide(deviceRect.left(), deviceTileSize); column <= floorDivide(deviceRect.right(), deviceTileSize); ++column)
+        {
+            const QPoint tile(column, row);
+            auto it = deviceTiles.find(tile);
+            if (it == deviceTiles.end())
+                it = deviceTiles.insert(tile, renderDeviceTile(tile));
+            visibleTiles.insert(tile);
+
+            painter->drawPixmap(QPoint(column * deviceTileSize, row * deviceTileSize), it.value());
+        }
+    }
+
+    painter->restore();
+
+    if (deviceTiles.size() > maxDeviceTiles)
+        deviceTiles.removeIf([&visibleTiles](QHash<QPoint, QPixmap>::iterator it) { return !visibleTiles.contains(it.key()); });
+}
+
+QPixmap QVTiledPixmapItem::renderDeviceTile(const QPoint tile) const
+{
+    QImage image(deviceTileSize, deviceTileSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+
+    QPainter tilePainter(&image);
+    tilePainter.setRenderHint(QPainter::SmoothPixmapTransform, currentTransformationMode == Qt::SmoothTransformation);
+    tilePainter.setTransform(deviceTileTransform * QTransform::fromTranslate(-tile.x() * deviceTileSize, -tile.y() * deviceTileSize));
+
+    // Only draw the part of the pixmap that lands in this tile, plus a margin for the filter
+    const QRectF tileArea = tilePainter.transform().inverted().mapRect(QRectF(image.rect()));
+    const QRect sourceRect = tileArea.toAlignedRect().adjusted(-deviceTileSourceMargin, -deviceTileSourceMargin, deviceTileSourceMargin, deviceTileSourceMargin) & currentPixmap.rect();
+    if (!sourceRect.isEmpty())
+        tilePainter.drawPixmap(QRectF(sourceRect), currentPixmap, QRectF(sourceRect));
+    tilePainter.end();
+
+    return QPixmap::fromImage(std::move(image));
+}
+
+void QVTiledPixmapItem::clearTiles()
+{
+    sourceTiles.clear();
+    deviceTiles.clear();
+}
+
+void QVTiledPixmapItem::invalidateTiles(const QRect &rect)
+{
+    sourceTiles.removeIf([&rect](QHash<QPoint, QPixmap>::iterator it) {
+        const QRect tileRect(it.key() * sourceTileSize, QSize(sourceTileSize, sourceTileSize));
+        return tileRect.adjusted(-sourceTileOverlap, -sourceTileOverlap, sourceTileOverlap, sourceTileOverlap).intersects(rect);
+    });
+
+    const QRect deviceRect = deviceTileTransform.mapRect(QRectF(rect)).toAlignedRect();
+    deviceTiles.removeIf([&deviceRect](QHash<QPoint, QPixmap>::iterator it) {
+        return QRect(it.key() * deviceTileSize, QSize(deviceTileSize, deviceTileSize)).intersects(deviceRect);
+    });
+}
+
+int QVTiledPixmapItem::getMaxTextureSize()
+{
+#ifdef OPENGL_LOADED
+    const QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (context && context != maxTextureSizeContext)
+    {
+        GLint size {0};
+        context->functions()->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &size);
+        maxTextureSizeContext = context;
+        maxTextureSize = size > 0 ? size : fallbackMaxTextureSize;
+    }
+#endif
+    return maxTextureSize;
+}
+
+int QVTiledPixmapItem::floorDivide(const int value, const int divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
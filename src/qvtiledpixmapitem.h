@@ -0,0 +1,84 @@
+#ifndef QVTILEDPIXMAPITEM_H
+#define QVTILEDPIXMAPITEM_H
+
+#include <QGraphicsItem>
+#include <QHash>
+#include <QPixmap>
+#include <QSet>
+#include <QTransform>
+
+class QOpenGLContext;
+
+// Draws a pixmap in tiles so that only the visible part of it is ever processed. On the raster
+// engine, tiles are rendered in device pixels at the current transform and reused while panning.
+class QVTiledPixmapItem : public QGraphicsItem
+{
+public:
+    explicit QVTiledPixmapItem(QGraphicsItem *parent = nullptr);
+
+    const QPixmap &pixmap() const { return currentPixmap; }
+
+    void setPixmap(const QPixmap &pixmap);
+
+    // Takes a pixmap of the same size that only differs from the current one within rect, so
+    // only the tiles over that part get redrawn
+    void updatePixmap(const QPixmap &pixmap, const QRect &rect);
+
+    // Lets go of the pixmap while keeping the geometry and tiles, so its owner can paint into it
+    // without a copy. Nothing is drawn until it's handed back with updatePixmap.
+    void releasePixmap();
+
+    bool isPixmapReleased() const { return pixmapReleased; }
+
+    Qt::TransformationMode transformationMode() const { return currentTransformationMode; }
+
+    void setTransformationMode(const Qt::TransformationMode mode);
+
+    QRectF boundingRect() const override;
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+protected:
+    void paintSourceTiles(QPainter *painter, const QRectF &exposedRect);
+
+    void paintDeviceTiles(QPainter *painter, const QRectF &exposedRect);
+
+    QPixmap renderDeviceTile(const QPoint tile) const;
+
+    void clearTiles();
+
+    void invalidateTiles(const QRect &rect);
+
+    int getMaxTextureSize();
+
+    static int floorDivide(const int value, const int divisor);
+
+private:
+    QPixmap currentPixmap;
+    QSize pixmapSize;
+    bool pixmapReleased {false};
+    Qt::TransformationMode currentTransformationMode {Qt::FastTransformation};
+
+    // Pieces of the pixmap with a small overlap so filtering doesn't leave seams, for paint
+    // engines that upload pixmaps as textures
+    QHash<QPoint, QPixmap> sourceTiles;
+
+    // Tiles in device pixels, on a grid anchored to the item's origin so that panning by whole
+    // pixels keeps their content the same
+    QHash<QPoint, QPixmap> deviceTiles;
+    QTransform deviceTileTransform;
+
+    // Queried from the context that's painting, since the limit depends on the driver
+    const QOpenGLContext *maxTextureSizeContext {nullptr};
+    int maxTextureSize {fallbackMaxTextureSize};
+
+    static constexpr int fallbackMaxTextureSize {4096};
+    static constexpr int sourceTileSize {1024};
+    static constexpr int sourceTileOverlap {1};
+    static constexpr int maxSourceTiles {64};
+    static constexpr int deviceTileSize {256};
+    static constexpr int maxDeviceTiles {256};
+    static constexpr int deviceTileSourceMargin {2};
+};
+
+#endif // QVTILEDPIXMAPITEM_H
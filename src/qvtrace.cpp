@@ -0,0 +1,141 @@
+#include "qvtrace.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QMutex>
+#include <QThread>
+
+namespace
+{
+QMutex traceMutex;
+QFile traceFile;
+QElapsedTimer traceTimer;
+bool hasWrittenEvent {false};
+std::atomic<int> nextThreadId {1};
+}
+
+bool QVTrace::start(const QString &filePath)
+{
+    QMutexLocker locker(&traceMutex);
+    if (enabled)
+        return true;
+
+    traceFile.setFileName(filePath);
+    if (!traceFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        qWarning() << "Unable to open trace file" << filePath << traceFile.errorString();
+        return false;
+    }
+
+    // The closing bracket is optional in this format, so the file stays usable after a crash
+    traceFile.write("[\n");
+    hasWrittenEvent = false;
+    traceTimer.start();
+    enabled = true;
+    return true;
+}
+
+void QVTrace::stop()
+{
+    QMutexLocker locker(&traceMutex);
+    if (!enabled)
+        return;
+
+    enabled = false;
+    traceFile.write("\n]\n");
+    traceFile.close();
+}
+
+double QVTrace::now()
+{
+    return traceTimer.isValid() ? traceTimer.nsecsElapsed() / 1000.0 : 0.0;
+}
+
+void QVTrace::complete(const char *name, const double startTime)
+{
+    if (isEnabled())
+        writeComplete(name, startTime, {});
+}
+
+void QVTrace::instant(const char *name)
+{
+    if (isEnabled())
+        writeInstant(name, {});
+}
+
+void QVTrace::writeComplete(const char *name, const double startTime, const QJsonObject &args)
+{
+    writeEvent({
+        {"name", name},
+        {"ph", "X"},
+        {"ts", startTime},
+        {"dur", now() - startTime},
+        {"args", args}
+    });
+}
+
+void QVTrace::writeInstant(const char *name, const QJsonObject &args)
+{
+    writeEvent({
+        {"name", name},
+        {"ph", "i"},
+        {"s", "t"},
+        {"ts", now()},
+        {"args", args}
+    });
+}
+
+void QVTrace::writeEvent(QJsonObject event)
+{
+    // Startup events can come before the application object exists
+    const bool isMainThread = !QCoreApplication::instance() || QThread::currentThread() == QCoreApplication::instance()->thread();
+    thread_local const int threadId = isMainThread ? 0 : nextThreadId++;
+    thread_local bool hasNamedThread = false;
+
+    event.insert("pid", QCoreApplication::applicationPid());
+    event.insert("tid", threadId);
+
+    QMutexLocker locker(&traceMutex);
+    if (!enabled)
+        return;
+
+    if (!hasNamedThread)
+    {
+        hasNamedThread = true;
+        const QJsonObject metadata {
+            {"name", "thread_name"},
+            {"ph", "M"},
+            {"pid", QCoreApplication::applicationPid()},
+            {"tid", threadId},
+            {"args", QJsonObject {{"name", isMainThread ? QString("Main") : QString("Worker %1").arg(threadId)}}}
+        };
+        traceFile.write(hasWrittenEvent ? ",\n" : "");
+        traceFile.write(QJsonDocument(metadata).toJson(QJsonDocument::Compact));
+        hasWrittenEvent = true;
+    }
+
+    traceFile.write(hasWrittenEvent ? ",\n" : "");
+    traceFile.write(QJsonDocument(event).toJson(QJsonDocument::Compact));
+    hasWrittenEvent = true;
+}
+
+QVTraceScope::QVTraceScope(const char *name)
+    : name(name)
+{
+    if (QVTrace::isEnabled())
+        startTime = QVTrace::now();
+}
+
+QVTraceScope::~QVTraceScope()
+{
+    if (QVTrace::isEnabled())
+        QVTrace::writeComplete(name, startTime, args);
+}
+
+void QVTraceScope::setArg(const char *key, const QJsonValue &value)
+{
+    if (QVTrace::isEnabled())
+        args.insert(QLatin1String(key), value);
+}
@@ -0,0 +1,72 @@
+#ifndef QVTRACE_H
+#define QVTRACE_H
+
+#include <atomic>
+#include <QJsonObject>
+#include <QString>
+
+// Writes events in the Chrome trace JSON format, which can be opened in chrome://tracing or
+// Perfetto. Tracing is off until started, and while it's off recording an event costs a single
+// atomic load; arguments are given as a function that builds them, which only runs when tracing.
+class QVTrace
+{
+public:
+    static bool start(const QString &filePath);
+
+    static void stop();
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    // Microseconds since tracing started
+    static double now();
+
+    static void complete(const char *name, const double startTime);
+
+    static void instant(const char *name);
+
+    template <typename BuildArgs>
+    static void instant(const char *name, BuildArgs &&buildArgs)
+    {
+        if (isEnabled())
+            writeInstant(name, buildArgs());
+    }
+
+private:
+    friend class QVTraceScope;
+
+    static void writeComplete(const char *name, const double startTime, const QJsonObject &args);
+
+    static void writeInstant(const char *name, const QJsonObject &args);
+
+    static void writeEvent(QJsonObject event);
+
+    static inline std::atomic<bool> enabled {false};
+};
+
+// Records a complete event covering its own lifetime
+class QVTraceScope
+{
+public:
+    explicit QVTraceScope(const char *name);
+
+    template <typename BuildArgs>
+    QVTraceScope(const char *name, BuildArgs &&buildArgs) : name(name)
+    {
+        if (QVTrace::isEnabled())
+        {
+            args = buildArgs();
+            startTime = QVTrace::now();
+        }
+    }
+
+    ~QVTraceScope();
+
+    void setArg(const char *key, const QJsonValue &value);
+
+private:
+    const char *name;
+    QJsonObject args;
+    double startTime {0.0};
+};
+
+#endif // QVTRACE_H
@@ -0,0 +1,139 @@
+#include "qvurldownloader.h"
+#include "qvapplication.h"
+
+#include <utility>
+#include <QDir>
+#include <QFileInfo>
+#include <QMimeDatabase>
+#include <QNetworkRequest>
+
+QVUrlDownloader::QVUrlDownloader(QNetworkAccessManager *networkAccessManager, const QUrl &url, QObject *parent) : QObject(parent)
+{
+    QNetworkRequest request(url);
+    request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    reply = networkAccessManager->get(request);
+    reply->setParent(this);
+
+    connect(reply, &QNetworkReply::readyRead, this, &QVUrlDownloader::onReadyRead);
+    connect(reply, &QNetworkReply::downloadProgress, this, &QVUrlDownloader::progress);
+    connect(reply, &QNetworkReply::finished, this, &QVUrlDownloader::onFinished);
+}
+
+void QVUrlDownloader::abort()
+{
+    if (reply)
+        reply->abort();
+}
+
+QTemporaryFile *QVUrlDownloader::takeFile()
+{
+    if (!isSupported)
+        return nullptr;
+
+    isSupported = false;
+    return std::exchange(file, nullptr);
+}
+
+QString QVUrlDownloader::getFileSuffix(const QUrl &url, const QString &contentType)
+{
+    const QSet<QString> &fileExtensionSet = qvApp->getFileExtensionSet();
+
+    const QString urlSuffix = "." + QFileInfo(url.path()).suffix().toLower();
+    if (fileExtensionSet.contains(urlSuffix))
+        return urlSuffix;
+
+    const QMimeType mimeType = QMimeDatabase().mimeTypeForName(contentType.section(';', 0, 0).trimmed());
+    if (mimeType.isValid())
+    {
+        for (const QString &suffix : mimeType.suffixes())
+        {
+            if (fileExtensionSet.contains("." + suffix))
+                return "." + suffix;
+        }
+    }
+
+    return {};
+}
+
+void QVUrlDownloader::onReadyRead()
+{
+    // Error pages aren't worth saving
+    if (!writeError.isEmpty() || reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() >= 400)
+        return;
+
+    if (!ensureFileOpen())
+    {
+        reply->abort();
+        return;
+    }
+
+    const QByteArray data = reply->readAll();
+    if (file->write(data) != data.size())
+    {
+        writeError = file->errorString();
+        reply->abort();
+    }
+}
+
+void QVUrlDownloader::onFinished()
+{
+    if (!writeError.isEmpty())
+    {
+        emit finished(writeError);
+        return;
+    }
+
+    if (reply->error() != QNetworkReply::NoError)
+    {
+        emit finished(QString::number(reply->error()) + ": " + reply->errorString());
+        return;
+    }
+
+    onReadyRead();
+    if (!writeError.isEmpty())
+    {
+        emit finished(writeError);
+        return;
+    }
+
+    if (file)
+    {
+        file->close();
+        isSupported = ensureSupportedSuffix();
+    }
+    emit finished({});
+}
+
+bool QVUrlDownloader::ensureFileOpen()
+{
+    if (file)
+        return true;
+
+    // The headers have arrived by now, so the content type is known
+    const QString suffix = getFileSuffix(reply->url(), reply->header(QNetworkRequest::ContentTypeHeader).toString());
+    file = new QTemporaryFile(this);
+    file->setFileTemplate(QDir::tempPath() + "/" + qvApp->applicationName() + ".XXXXXX" + suffix);
+    if (!file->open())
+    {
+        writeError = file->errorString();
+        return false;
+    }
+    return true;
+}
+
+bool QVUrlDownloader::ensureSupportedSuffix()
+{
+    const QString fileName = file->fileName();
+    const QSet<QString> &fileExtensionSet = qvApp->getFileExtensionSet();
+    if (fileExtensionSet.contains("." + QFileInfo(fileName).suffix().toLower()))
+        return true;
+
+    // Neither the URL nor the server said what it was, so go by what was actually downloaded
+    const QMimeType mimeType = QMimeDatabase().mimeTypeForFile(fileName, QMimeDatabase::MatchContent);
+    for (const QString &suffix : mimeType.suffixes())
+    {
+        if (fileExtensionSet.contains("." + suffix))
+            return file->rename(fileName + "." + suffix);
+    }
+    return false;
+}
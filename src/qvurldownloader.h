@@ -0,0 +1,53 @@
+#ifndef QVURLDOWNLOADER_H
+#define QVURLDOWNLOADER_H
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QObject>
+#include <QPointer>
+#include <QTemporaryFile>
+#include <QUrl>
+
+// Streams a download straight to a temporary file as the bytes arrive, keeping the original
+// encoding so animations and metadata survive and the image only has to be decoded once.
+class QVUrlDownloader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit QVUrlDownloader(QNetworkAccessManager *networkAccessManager, const QUrl &url, QObject *parent = nullptr);
+
+    void abort();
+
+    // Hands over the downloaded file if it finished without an error and holds a supported image
+    QTemporaryFile *takeFile();
+
+    // Picks a supported extension (with the dot), first from the URL and then from the content type
+    static QString getFileSuffix(const QUrl &url, const QString &contentType);
+
+signals:
+    void progress(qint64 bytesReceived, qint64 bytesTotal);
+
+    // The error string is empty unless the download itself failed
+    void finished(const QString &errorString);
+
+protected:
+    void onReadyRead();
+
+    void onFinished();
+
+    bool ensureFileOpen();
+
+    bool ensureSupportedSuffix();
+
+private:
+    QPointer<QNetworkReply> reply;
+
+    QTemporaryFile *file {nullptr};
+
+    QString writeError;
+
+    bool isSupported {false};
+};
+
+#endif // QVURLDOWNLOADER_H
@@ -63,20 +63,38 @@ void SettingsManager::loadSettings()
 {
     QSettings settings;
     settings.beginGroup("options");
-    bool changed = false;
+    QSet<QString> changedKeys;
 
-    const auto keys = settingsLibrary.keys();
-    for (const auto &key : keys)
+    for (auto it = settingsLibrary.begin(); it != settingsLibrary.end(); ++it)
     {
-        auto &setting = settingsLibrary[key];
-        if (setting.value != settings.value(key, setting.defaultValue))
-            changed = true;
+        const QVariant value = settings.value(it.key(), it->defaultValue);
+        if (it->value != value)
+            changedKeys << it.key();
 
-        setting.value = settings.value(key, setting.defaultValue);
+        it->value = value;
     }
 
-    if (changed)
-        emit settingsUpdated();
+    if (!changedKeys.isEmpty())
+    {
+        updateSnapshot();
+        emit settingsUpdated(changedKeys);
+    }
+}
+
+void SettingsManager::updateSnapshot()
+{
+    snapshot.titleBarMode = getEnum<Qv::TitleBarText>("titlebarmode");
+    snapshot.customTitleBarText = getString("customtitlebartext");
+    snapshot.fullscreenDetails = getBoolean("fullscreendetails");
+    snapshot.windowResizeMode = getEnum<Qv::WindowResizeMode>("windowresizemode");
+    snapshot.minWindowResizedPercentage = getInteger("minwindowresizedpercentage");
+    snapshot.maxWindowResizedPercentage = getInteger("maxwindowresizedpercentage");
+    snapshot.afterMatchingSizeMode = getEnum<Qv::AfterMatchingSize>("aftermatchingsizemode");
+    snapshot.originalSizeAsToggle = getBoolean("originalsizeastoggle");
+    snapshot.slideshowDirection = getEnum<Qv::SlideshowDirection>("slideshowdirection");
+    snapshot.slideshowKeepsWindowOnTop = getBoolean("slideshowkeepswindowontop");
+    snapshot.askDelete = getBoolean("askdelete");
+    snapshot.afterDelete = getEnum<Qv::AfterDelete>("afterdelete");
 }
 
 const QVariant SettingsManager::getSetting(const QString &key, bool defaults) const
@@ -207,6 +225,7 @@ void SettingsManager::initializeSettingsLibrary()
     settingsLibrary.insert("submenuicons", {true, {}});
     settingsLibrary.insert("slideshowkeepswindowontop", {false, {}});
     settingsLibrary.insert("reusewindow", {false, {}});
+    settingsLibrary.insert("singleinstance", {false, {}});
     settingsLibrary.insert("persistsession", {false, {}});
     // Image
     settingsLibrary.insert("smoothscalingmode", {static_cast<int>(Qv::SmoothScalingMode::Expensive), {}});
@@ -231,6 +250,7 @@ void SettingsManager::initializeSettingsLibrary()
     settingsLibrary.insert("disabledelayedconstraint", {false, {}});
     settingsLibrary.insert("originalsizeastoggle", {false, {}});
     settingsLibrary.insert("colorspaceconversion", {static_cast<int>(Qv::ColorSpaceConversion::AutoDetect), {}});
+    settingsLibrary.insert("hardwareacceleration", {false, {}});
     // Miscellaneous
     settingsLibrary.insert("language", {"system", {}});
     settingsLibrary.insert("sortmode", {static_cast<int>(Qv::SortMode::Name), {}});
@@ -1,6 +1,8 @@
 #ifndef SETTINGSMANAGER_H
 #define SETTINGSMANAGER_H
 
+#include "qvnamespace.h"
+
 #include <QTranslator>
 #include <QVariant>
 
@@ -13,6 +15,23 @@ public:
         QVariant value;
     };
 
+    // Typed copies of the settings read on hot paths, like building the title on every zoom or
+    // each slideshow step. Refreshed before settingsUpdated is emitted.
+    struct Snapshot {
+        Qv::TitleBarText titleBarMode {Qv::TitleBarText::Minimal};
+        QString customTitleBarText;
+        bool fullscreenDetails {false};
+        Qv::WindowResizeMode windowResizeMode {Qv::WindowResizeMode::WhenLaunching};
+        int minWindowResizedPercentage {20};
+        int maxWindowResizedPercentage {70};
+        Qv::AfterMatchingSize afterMatchingSizeMode {Qv::AfterMatchingSize::CenterOnPrevious};
+        bool originalSizeAsToggle {false};
+        Qv::SlideshowDirection slideshowDirection {Qv::SlideshowDirection::Forward};
+        bool slideshowKeepsWindowOnTop {false};
+        bool askDelete {true};
+        Qv::AfterDelete afterDelete {Qv::AfterDelete::MoveForward};
+    };
+
     explicit SettingsManager(QObject *parent = nullptr);
 
     void loadSettings();
@@ -35,6 +54,11 @@ public:
 
     const QHash<QString, SSetting> &getSettings() const { return settingsLibrary; }
 
+    // For listeners applying every setting on their first load
+    QSet<QString> getAllKeys() const { return Qv::listToSet(settingsLibrary.keys()); }
+
+    const Snapshot &getSnapshot() const { return snapshot; }
+
     bool isDefault(const QString &key) const;
 
     static void migrateOldSettings();
@@ -42,11 +66,14 @@ public:
     static void copyFromOfficial();
 
 signals:
-    void settingsUpdated();
+    // Only carries the keys whose values actually changed, so listeners can skip unrelated work
+    void settingsUpdated(const QSet<QString> &changedKeys);
 
 protected:
     void initializeSettingsLibrary();
 
+    void updateSnapshot();
+
 private:
     QString getSystemLanguage() const;
 
@@ -55,6 +82,7 @@ private:
     QTranslator qtTranslator;
     QTranslator appTranslator;
     QHash<QString, SSetting> settingsLibrary;
+    Snapshot snapshot;
 };
 
 #endif // SETTINGSMANAGER_H
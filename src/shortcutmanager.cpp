@@ -118,6 +118,7 @@ void ShortcutManager::initializeShortcutsList()
     shortcutsList.append({tr("Reset Speed"), "resetspeed", QStringList(QKeySequence(Qt::Key_Backslash).toString()), {}});
     shortcutsList.append({tr("Increase Speed"), "increasespeed", QStringList(QKeySequence(Qt::Key_BracketRight).toString()), {}});
     shortcutsList.append({tr("Toggle Slideshow"), "slideshow", {}, {}});
+    shortcutsList.append({tr("Performance Overlay"), "performanceoverlay", {}, {}});
     shortcutsList.append({tr("Settings"), "options", keyBindingsToStringList(QKeySequence::Preferences), {}});
     if (QOperatingSystemVersion::current() < QOperatingSystemVersion(QOperatingSystemVersion::MacOS, 13)) {
         shortcutsList.last().readableName = tr("Preferences");
@@ -13,8 +13,13 @@ SOURCES += \
     $$PWD/qvinfodialog.cpp \
     $$PWD/qvimagecore.cpp \
     $$PWD/qvimageloader.cpp \
+    $$PWD/qvimagescaler.cpp \
     $$PWD/qvmovie.cpp \
+    $$PWD/qvtiledpixmapitem.cpp \
+    $$PWD/qvtrace.cpp \
+    $$PWD/qvurldownloader.cpp \
     $$PWD/qvshortcutdialog.cpp \
+    $$PWD/qvsingleinstance.cpp \
     $$PWD/qvwindows11style.cpp \
     $$PWD/actionmanager.cpp \
     $$PWD/axislocker.cpp \
@@ -44,8 +49,13 @@ HEADERS += \
     $$PWD/qvinfodialog.h \
     $$PWD/qvimagecore.h \
     $$PWD/qvimageloader.h \
+    $$PWD/qvimagescaler.h \
     $$PWD/qvmovie.h \
+    $$PWD/qvtiledpixmapitem.h \
+    $$PWD/qvtrace.h \
+    $$PWD/qvurldownloader.h \
     $$PWD/qvshortcutdialog.h \
+    $$PWD/qvsingleinstance.h \
     $$PWD/qvwindows11style.h \
     $$PWD/actionmanager.h \
     $$PWD/axislocker.h \
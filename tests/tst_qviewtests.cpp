@@ -1,11 +1,19 @@
 #include <QtTest>
+#include <QBuffer>
 #include <QFile>
+#include <QNetworkProxy>
+#include <QSettings>
 #include <QSignalSpy>
+#include <QTcpServer>
+#include <QTcpSocket>
 #include <QTemporaryDir>
 #include <QThreadPool>
 
 #include "qvapplication.h"
 #include "qvimageloader.h"
+#include "qvimagescaler.h"
+#include "qvmovie.h"
+#include "qvurldownloader.h"
 
 class ImageLoaderTests : public QObject
 {
@@ -20,6 +28,13 @@ private slots:
     void testImageLoaderDisabledRetention();
     void testImageLoaderCachedErrorRetry();
     void testImageLoaderDestructionDuringLoad();
+    void testImageLoaderStaticImageNotPrepared();
+    void testImageLoaderAnimationPrepared();
+    void testImageLoaderPrefetchAdopted();
+    void testImageLoaderInMemorySource();
+    void testImageLoaderSharedCache();
+    void testImageLoaderSharedPreparedAnimation();
+    void testImageLoaderPrefetchShared();
 };
 
 class ActionManagerTests : public QObject
@@ -30,6 +45,40 @@ private slots:
     void testClonedActionsUntracked();
 };
 
+class MovieTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testMovieReportsChangedFrameRects();
+};
+
+class SettingsManagerTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testSettingsUpdatedChangedKeys();
+};
+
+class ImageScalerTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testImageScalerFlatColor();
+    void testImageScalerAverage();
+};
+
+class UrlDownloaderTests : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void testUrlDownloaderKeepsOriginalBytes();
+    void testUrlDownloaderHttpError();
+};
+
 static QString createTestImage(const QTemporaryDir &dir, const QString &name, const QColor color)
 {
     const QString path = dir.filePath(name + ".png");
@@ -40,6 +89,21 @@ static QString createTestImage(const QTemporaryDir &dir, const QString &name, co
     return path;
 }
 
+static QString createTestAnimation(const QTemporaryDir &dir, const QString &name)
+{
+    // 4x4, three solid frames (red, green, blue) 100 ms apart
+    const QByteArray gifData = QByteArray::fromHex(
+        "47494638396104000400f10000ff000000ff000000ffffffff21ff0b4e45545343415045322e300301000000"
+        "21f904040a0000002c0000000004000400000204848f090500"
+        "21f904040a0000002c00000000040004000002048c8f190500"
+        "21f904040a0000002c0000000004000400000204948f2905003b");
+    const QString path = dir.filePath(name + ".gif");
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(gifData) != gifData.size())
+        return {};
+    return path;
+}
+
 void ImageLoaderTests::testImageLoaderPriorities()
 {
     QTemporaryDir dir;
@@ -270,6 +334,245 @@ void ImageLoaderTests::testImageLoaderDestructionDuringLoad()
     QCOMPARE(startedPaths, QStringList {target});
 }
 
+void ImageLoaderTests::testImageLoaderStaticImageNotPrepared()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = createTestImage(dir, "image", Qt::yellow);
+    QVERIFY(!path.isEmpty());
+
+    QVImageLoader loader;
+    QSignalSpy readySpy(&loader, &QVImageLoader::imageReady);
+
+    loader.requestImage(path);
+    QTRY_COMPARE_WITH_TIMEOUT(readySpy.size(), 1, 5000);
+    const auto result = qvariant_cast<QVImageLoader::Result>(readySpy.at(0).at(1));
+    QVERIFY(!result.image.isNull());
+    QVERIFY(!result.preparedAnimation);
+}
+
+void ImageLoaderTests::testImageLoaderAnimationPrepared()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString foregroundPath = createTestAnimation(dir, "foreground");
+    const QString preloadPath = createTestAnimation(dir, "preload");
+    QVERIFY(!foregroundPath.isEmpty());
+    QVERIFY(!preloadPath.isEmpty());
+
+    QVImageLoader loader;
+    bool hadReader = false;
+    std::unique_ptr<QImageReader> claimedReader;
+    connect(&loader, &QVImageLoader::imageReady, this, [&](quint64, const QVImageLoader::Result &result) {
+        hadReader = result.preparedAnimation && result.preparedAnimation->reader;
+        if (hadReader)
+            claimedReader = std::move(result.preparedAnimation->reader);
+    });
+    QSignalSpy readySpy(&loader, &QVImageLoader::imageReady);
+
+    // The request being shown gets the frames and the reader, positioned just past them
+    loader.requestImage(foregroundPath);
+    QTRY_COMPARE_WITH_TIMEOUT(readySpy.size(), 1, 5000);
+    auto result = qvariant_cast<QVImageLoader::Result>(readySpy.takeFirst().at(1));
+    QVERIFY(result.preparedAnimation);
+    QVERIFY(hadReader);
+    QCOMPARE(result.preparedAnimation->frames.size(), 3);
+    QCOMPARE(result.preparedAnimation->frameDelays, QList<int>({100, 100, 100}));
+    QCOMPARE(result.preparedAnimation->frameUpdateRects, QList<QRect>(3, QRect(0, 0, 4, 4)));
+    QCOMPARE(result.preparedAnimation->frames.at(1).pixelColor(0, 0), QColor(Qt::green));
+    QCOMPARE(result.preparedAnimation->frames.at(2).pixelColor(0, 0), QColor(Qt::blue));
+    // The first frame is the decoded image itself rather than a second decode of it
+    QVERIFY(result.preparedAnimation->frames.at(0).constBits() == result.image.constBits());
+    QVERIFY(claimedReader);
+    QVERIFY(!claimedReader->canRead());
+
+    // A preload keeps its frames, counted as cached, but lets go of the file
+    loader.setDesiredImages({{preloadPath, 1}});
+    QTRY_COMPARE_WITH_TIMEOUT(loader.getStats().cachedCount, 1, 5000);
+    const qint64 imageBytes = result.image.sizeInBytes();
+    QCOMPARE(loader.getStats().cachedBytes, imageBytes + result.preparedAnimation->frames.at(1).sizeInBytes() * 2);
+
+    loader.requestImage(preloadPath);
+    QTRY_COMPARE_WITH_TIMEOUT(readySpy.size(), 1, 5000);
+    result = qvariant_cast<QVImageLoader::Result>(readySpy.takeFirst().at(1));
+    QVERIFY(result.preparedAnimation);
+    QVERIFY(!hadReader);
+    QCOMPARE(result.preparedAnimation->frames.size(), 3);
+}
+
+void ImageLoaderTests::testImageLoaderPrefetchAdopted()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString inFlightPath = createTestImage(dir, "in-flight", Qt::red);
+    const QString finishedPath = createTestImage(dir, "finished", Qt::green);
+    QVERIFY(!inFlightPath.isEmpty());
+    QVERIFY(!finishedPath.isEmpty());
+
+    // Taken over while still decoding
+    {
+        QVImageLoader::prefetchImage(inFlightPath, 1920);
+        QVImageLoader loader;
+        QSignalSpy startedSpy(&loader, &QVImageLoader::loadStarted);
+        QSignalSpy readySpy(&loader, &QVImageLoader::imageReady);
+
+        loader.requestImage(inFlightPath);
+        QTRY_COMPARE_WITH_TIMEOUT(readySpy.size(), 1, 5000);
+        QCOMPARE(startedSpy.size(), 0);
+        const auto result = qvariant_cast<QVImageLoader::Result>(readySpy.at(0).at(1));
+        QCOMPARE(result.absoluteFilePath, inFlightPath);
+        QVERIFY(!result.image.isNull());
+    }
+
+    // Taken over after it finished
+    {
+        QVImageLoader::prefetchImage(finishedPath, 1920);
+        QThreadPool::globalInstance()->waitForDone();
+        QCoreApplication::processEvents();
+
+        QVImageLoader loader;
+        QSignalSpy startedSpy(&loader, &QVImageLoader::loadStarted);
+        QSignalSpy readySpy(&loader, &QVImageLoader::imageReady);
+
+        loader.requestImage(finishedPath);
+        QTRY_COMPARE_WITH_TIMEOUT(readySpy.size(), 1, 5000);
+        QCOMPARE(startedSpy.size(), 0);
+        QCOMPARE(qvariant_cast<QVImageLoader::Result>(readySpy.at(0).at(1)).absoluteFilePath, finishedPath);
+    }
+}
+
+void ImageLoaderTests::testImageLoaderInMemorySource()
+{
+    QImage image(32, 32, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    QByteArray imageData;
+    QBuffer buffer(&imageData);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(image.save(&buffer, "png"));
+
+    // Equal contents share an identity no matter where they came from
+    const QVImageLoader::Source source = QVImageLoader::Source::fromData(imageData);
+    QVERIFY(source.isInMemory());
+    QBuffer device(&imageData);
+    QCOMPARE(QVImageLoader::Source::fromDevice(&device).key, source.key);
+
+    QVImageLoader loader;
+    QSignalSpy startedSpy(&loader, &QVImageLoader::loadStarted);
+    QSignalSpy readySpy(&loader, &QVImageLoader::imageReady);
+
+    loader.requestImage(source);
+    const quint64 requestId = loader.requestImage(QVImageLoader::Source::fromData(imageData));
+    QTRY_COMPARE_WITH_TIMEOUT(readySpy.size(), 1, 5000);
+    QCOMPARE(startedSpy.size(), 1);
+    QCOMPARE(readySpy.at(0).at(0).toULongLong(), requestId);
+
+    const auto result = readySpy.at(0).at(1).value<QVImageLoader::Result>();
+    QVERIFY(!result.errorData.has_value());
+    QVERIFY(result.source.isInMemory());
+    QVERIFY(result.absoluteFilePath.isEmpty());
+    QCOMPARE(result.image.pixel(0, 0), QColor(Qt::red).rgb());
+}
+
+void ImageLoaderTests::testImageLoaderSharedCache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = createTestImage(dir, "image", Qt::red);
+    QVERIFY(!path.isEmpty());
+
+    const auto sharedCache = std::make_shared<QVImageLoader::SharedCache>();
+    QVImageLoader first;
+    QVImageLoader second;
+    first.setSharedCache(sharedCache);
+    second.setSharedCache(sharedCache);
+    QSignalSpy firstReadySpy(&first, &QVImageLoader::imageReady);
+    QSignalSpy secondReadySpy(&second, &QVImageLoader::imageReady);
+
+    // Keep it cached in the first loader, as if it were that window's current image
+    first.requestImage(path);
+    first.setDesiredImages({{path, 0}});
+    second.requestImage(path);
+    QTRY_COMPARE_WITH_TIMEOUT(firstReadySpy.size(), 1, 5000);
+    QTRY_COMPARE_WITH_TIMEOUT(secondReadySpy.size(), 1, 5000);
+    QCOMPARE(first.getStats().sharedJobCount, quint64(0));
+    QCOMPARE(second.getStats().sharedJobCount, quint64(1));
+
+    const auto firstResult = firstReadySpy.at(0).at(1).value<QVImageLoader::Result>();
+    const auto secondResult = secondReadySpy.at(0).at(1).value<QVImageLoader::Result>();
+    QCOMPARE(firstResult.image.constBits(), secondResult.image.constBits());
+
+    // Finished results are shared too, but a reload always decodes again
+    second.requestImage(path);
+    QTRY_COMPARE_WITH_TIMEOUT(secondReadySpy.size(), 2, 5000);
+    QCOMPARE(second.getStats().sharedJobCount, quint64(2));
+
+    second.requestImage(path, true);
+    QTRY_COMPARE_WITH_TIMEOUT(secondReadySpy.size(), 3, 5000);
+    QCOMPARE(second.getStats().sharedJobCount, quint64(2));
+}
+
+void ImageLoaderTests::testImageLoaderSharedPreparedAnimation()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = createTestAnimation(dir, "animation");
+    QVERIFY(!path.isEmpty());
+
+    const auto sharedCache = std::make_shared<QVImageLoader::SharedCache>();
+    QVImageLoader first;
+    QVImageLoader second;
+    first.setSharedCache(sharedCache);
+    second.setSharedCache(sharedCache);
+    QSignalSpy firstReadySpy(&first, &QVImageLoader::imageReady);
+    QSignalSpy secondReadySpy(&second, &QVImageLoader::imageReady);
+
+    first.requestImage(path);
+    first.setDesiredImages({{path, 0}});
+    QTRY_COMPARE_WITH_TIMEOUT(firstReadySpy.size(), 1, 5000);
+    second.setDesiredImages({{path, 1}});
+    QTRY_COMPARE_WITH_TIMEOUT(second.getStats().cachedCount, 1, 5000);
+    second.requestImage(path);
+    QTRY_COMPARE_WITH_TIMEOUT(secondReadySpy.size(), 1, 5000);
+    QCOMPARE(second.getStats().sharedJobCount, quint64(1));
+
+    // Each loader has frames of its own, so neither can trim the other's
+    const auto firstResult = firstReadySpy.at(0).at(1).value<QVImageLoader::Result>();
+    const auto secondResult = secondReadySpy.at(0).at(1).value<QVImageLoader::Result>();
+    QVERIFY(firstResult.preparedAnimation);
+    QVERIFY(secondResult.preparedAnimation);
+    QVERIFY(firstResult.preparedAnimation != secondResult.preparedAnimation);
+    QCOMPARE(secondResult.preparedAnimation->frames.size(), 3);
+    QVERIFY(firstResult.preparedAnimation->frames.at(1).constBits() == secondResult.preparedAnimation->frames.at(1).constBits());
+}
+
+void ImageLoaderTests::testImageLoaderPrefetchShared()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = createTestImage(dir, "image", Qt::red);
+    QVERIFY(!path.isEmpty());
+
+    // Two windows opening the file given on the command line at once decode it only once
+    QVImageLoader::prefetchImage(path, 1920);
+    const auto sharedCache = std::make_shared<QVImageLoader::SharedCache>();
+    QVImageLoader first;
+    QVImageLoader second;
+    first.setSharedCache(sharedCache);
+    second.setSharedCache(sharedCache);
+    QSignalSpy firstReadySpy(&first, &QVImageLoader::imageReady);
+    QSignalSpy secondReadySpy(&second, &QVImageLoader::imageReady);
+
+    first.requestImage(path);
+    second.requestImage(path);
+    QTRY_COMPARE_WITH_TIMEOUT(firstReadySpy.size(), 1, 5000);
+    QTRY_COMPARE_WITH_TIMEOUT(secondReadySpy.size(), 1, 5000);
+    QCOMPARE(second.getStats().sharedJobCount, quint64(1));
+
+    const auto firstResult = firstReadySpy.at(0).at(1).value<QVImageLoader::Result>();
+    const auto secondResult = secondReadySpy.at(0).at(1).value<QVImageLoader::Result>();
+    QVERIFY(firstResult.image.constBits() == secondResult.image.constBits());
+}
+
 void ActionManagerTests::testClonedActionsUntracked()
 {
     // Get initial counts of certain actions
@@ -291,6 +594,168 @@ void ActionManagerTests::testClonedActionsUntracked()
     QCOMPARE(qvApp->getActionManager().getAllInstancesOfAction("open").length(), openCount);
 }
 
+void MovieTests::testMovieReportsChangedFrameRects()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    // 4x4: a red background, then a 2x2 green square at (1,1) that is disposed of to the
+    // background, then a 2x2 blue square at (2,2)
+    const QByteArray gifData = QByteArray::fromHex(
+        "47494638396104000400f10000ff000000ff000000ffffffff21ff0b4e45545343415045322e300301000000"
+        "21f904040a0000002c0000000004000400000204848f090500"
+        "21f904080a0000002c01000100020002000002028c5300"
+        "21f904040a0000002c0200020002000200000202945500"
+        "3b");
+    const QString path = dir.filePath("frames.gif");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    QCOMPARE(file.write(gifData), gifData.size());
+    file.close();
+
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QList<QRect> updateRects = QVMovie::readGifUpdateRects(&file);
+    file.close();
+    QCOMPARE(updateRects, QList<QRect>({QRect(0, 0, 4, 4), QRect(1, 1, 2, 2), QRect(1, 1, 3, 3)}));
+
+    QVMovie movie(path);
+    movie.setCacheMode(QVMovie::CacheAll);
+    movie.setFrameUpdateRects(updateRects);
+    QSignalSpy updatedSpy(&movie, &QVMovie::updated);
+
+    QVERIFY(movie.jumpToFrame(0));
+    QVERIFY(movie.jumpToFrame(1));
+    QVERIFY(movie.jumpToFrame(2));
+    QCOMPARE(updatedSpy.size(), 3);
+    QCOMPARE(updatedSpy.at(0).at(0).toRect(), QRect(0, 0, 4, 4));
+    QCOMPARE(updatedSpy.at(1).at(0).toRect(), QRect(1, 1, 2, 2));
+    // The green square was cleared, so its area changes along with the blue one
+    QCOMPARE(updatedSpy.at(2).at(0).toRect(), QRect(1, 1, 3, 3));
+    QCOMPARE(movie.currentPixmap().toImage().pixelColor(3, 3), QColor(Qt::blue));
+
+    // Going back doesn't build on what's shown, so the whole frame is reported
+    QVERIFY(movie.jumpToFrame(0));
+    QCOMPARE(updatedSpy.last().at(0).toRect(), QRect(0, 0, 4, 4));
+}
+
+void SettingsManagerTests::testSettingsUpdatedChangedKeys()
+{
+    auto &settingsManager = qvApp->getSettingsManager();
+    QSignalSpy spy(&settingsManager, &SettingsManager::settingsUpdated);
+
+    QSettings settings;
+    settings.beginGroup("options");
+    const QVariant originalValue = settings.value("slideshowtimer");
+    const double slideshowTimer = settingsManager.getDouble("slideshowtimer");
+
+    // Only the key that was written should be reported
+    settings.setValue("slideshowtimer", slideshowTimer + 1.0);
+    settingsManager.loadSettings();
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.takeFirst().first().value<QSet<QString>>(), QSet<QString>({"slideshowtimer"}));
+    QCOMPARE(settingsManager.getDouble("slideshowtimer"), slideshowTimer + 1.0);
+
+    // Nothing changed, so nothing is emitted
+    settingsManager.loadSettings();
+    QCOMPARE(spy.count(), 0);
+
+    if (originalValue.isValid())
+        settings.setValue("slideshowtimer", originalValue);
+    else
+        settings.remove("slideshowtimer");
+    settingsManager.loadSettings();
+    QCOMPARE(settingsManager.getDouble("slideshowtimer"), slideshowTimer);
+}
+
+void ImageScalerTests::testImageScalerFlatColor()
+{
+    QImage image(1000, 750, QImage::Format_ARGB32_Premultiplied);
+    image.fill(QColor(10, 120, 250, 200));
+
+    // Uneven ratios split source pixels between outputs, but the weights must still add up
+    const QImage scaled = QVImageScaler::scaled(image, QSize(333, 257));
+    QCOMPARE(scaled.size(), QSize(333, 257));
+    const QRgb expected = image.pixel(0, 0);
+    for (int y = 0; y < scaled.height(); ++y)
+    {
+        for (int x = 0; x < scaled.width(); ++x)
+            QCOMPARE(scaled.pixel(x, y), expected);
+    }
+}
+
+void ImageScalerTests::testImageScalerAverage()
+{
+    QImage image(2, 2, QImage::Format_RGB32);
+    image.setPixel(0, 0, qRgb(0, 0, 0));
+    image.setPixel(1, 0, qRgb(255, 0, 0));
+    image.setPixel(0, 1, qRgb(0, 255, 0));
+    image.setPixel(1, 1, qRgb(0, 0, 255));
+
+    const QImage scaled = QVImageScaler::scaled(image, QSize(1, 1));
+    QCOMPARE(scaled.pixel(0, 0), qRgb(64, 64, 64));
+}
+
+// Stands in for a web server, answering every request with the same response
+static void serveHttp(QTcpServer &server, const QByteArray &response)
+{
+    QObject::connect(&server, &QTcpServer::newConnection, &server, [&server, response]{
+        while (QTcpSocket *socket = server.nextPendingConnection())
+        {
+            QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+            QObject::connect(socket, &QTcpSocket::readyRead, socket, [socket, response]{
+                if (!socket->peek(socket->bytesAvailable()).contains("\r\n\r\n"))
+                    return;
+                socket->readAll();
+                socket->write(response);
+                socket->disconnectFromHost();
+            });
+        }
+    });
+}
+
+void UrlDownloaderTests::testUrlDownloaderKeepsOriginalBytes()
+{
+    QImage image(32, 32, QImage::Format_RGB32);
+    image.fill(Qt::red);
+    QByteArray imageData;
+    QBuffer buffer(&imageData);
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    QVERIFY(image.save(&buffer, "png"));
+
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    serveHttp(server, "HTTP/1.1 200 OK\r\nContent-Type: image/png\r\nContent-Length: " + QByteArray::number(imageData.size()) + "\r\nConnection: close\r\n\r\n" + imageData);
+
+    QNetworkAccessManager networkAccessManager;
+    networkAccessManager.setProxy(QNetworkProxy::NoProxy);
+    QVUrlDownloader downloader(&networkAccessManager, QUrl(QString("http://127.0.0.1:%1/image").arg(server.serverPort())));
+    QSignalSpy finishedSpy(&downloader, &QVUrlDownloader::finished);
+    QVERIFY(finishedSpy.wait(5000));
+    QCOMPARE(finishedSpy.first().first().toString(), QString());
+
+    // The URL has no extension, so it should come from the content type
+    std::unique_ptr<QTemporaryFile> file(downloader.takeFile());
+    QVERIFY(file);
+    QVERIFY(file->fileName().endsWith(".png"));
+    QVERIFY(file->open());
+    QCOMPARE(file->readAll(), imageData);
+}
+
+void UrlDownloaderTests::testUrlDownloaderHttpError()
+{
+    QTcpServer server;
+    QVERIFY(server.listen(QHostAddress::LocalHost));
+    serveHttp(server, "HTTP/1.1 404 Not Found\r\nContent-Type: text/html\r\nContent-Length: 9\r\nConnection: close\r\n\r\nNot found");
+
+    QNetworkAccessManager networkAccessManager;
+    networkAccessManager.setProxy(QNetworkProxy::NoProxy);
+    QVUrlDownloader downloader(&networkAccessManager, QUrl(QString("http://127.0.0.1:%1/missing.png").arg(server.serverPort())));
+    QSignalSpy finishedSpy(&downloader, &QVUrlDownloader::finished);
+    QVERIFY(finishedSpy.wait(5000));
+    QVERIFY(!finishedSpy.first().first().toString().isEmpty());
+    QVERIFY(downloader.takeFile() == nullptr);
+}
+
 int main(int argc, char *argv[])
 {
     QVApplication app(argc, argv);
@@ -298,8 +763,16 @@ int main(int argc, char *argv[])
 
     ImageLoaderTests imageLoaderTests;
     ActionManagerTests actionManagerTests;
+    MovieTests movieTests;
+    SettingsManagerTests settingsManagerTests;
+    ImageScalerTests imageScalerTests;
+    UrlDownloaderTests urlDownloaderTests;
     int result = QTest::qExec(&imageLoaderTests, argc, argv);
     result |= QTest::qExec(&actionManagerTests, argc, argv);
+    result |= QTest::qExec(&movieTests, argc, argv);
+    result |= QTest::qExec(&settingsManagerTests, argc, argv);
+    result |= QTest::qExec(&imageScalerTests, argc, argv);
+    result |= QTest::qExec(&urlDownloaderTests, argc, argv);
     return result;
 }
 